@@ -1,10 +1,21 @@
 #include "bsp_i2c.h"
 #include "cmsis_os.h"
 
+static uint8_t tx_dma_flag;   // 最近一次异步传输是否为DMA发送
+
 static void I2cResetBus(I2C_HandleTypeDef *hi2c, GPIO_TypeDef *GPIOx, uint16_t SCL_Pin, uint16_t SDA_Pin)
 {
 	GPIO_InitTypeDef GPIO_InitStruct;
 
+	hi2c->Instance->CR2 &= ~(I2C_CR2_DMAEN | I2C_CR2_LAST);
+	if(NULL != hi2c->hdmatx)
+	{
+		HAL_DMA_Abort(hi2c->hdmatx);
+	}
+	if(NULL != hi2c->hdmarx)
+	{
+		HAL_DMA_Abort(hi2c->hdmarx);
+	}
 	hi2c->Instance->CR1 &= ~I2C_CR1_PE;
 
 	HAL_GPIO_DeInit(GPIOx,  SCL_Pin | SDA_Pin);
@@ -35,3 +46,84 @@ void BspI2cResetBus(void)
 {
 	I2cResetBus(I2C_MASTER, GPIOB, GPIO_PIN_10, GPIO_PIN_11);
 }
+
+/** 
+  * @描述   I2C主机DMA发送，发送完成后调用HAL_I2C_MasterTxCpltCallback
+  * @参数   addr：7位从机地址
+  * @参数   buf：发送数据地址，可以位于flash中
+  * @参数   size：发送数据量
+  * @返回值 HAL状态
+  */
+HAL_StatusTypeDef BspI2cMasterTransmitDma(uint16_t addr, uint8_t *buf, uint16_t size)
+{
+	tx_dma_flag = 1;
+	return HAL_I2C_Master_Transmit_DMA(I2C_MASTER, addr << 1, buf, size);
+}
+
+/** 
+  * @描述   I2C主机DMA接收，接收完成后调用HAL_I2C_MasterRxCpltCallback
+  *         STM32F1的I2C在主机接收1字节和2字节时，必须在ADDR标志清除的同时完成ACK、POS和STOP的设置，
+  *         DMA方式无法保证这一时序(见doc/ES0340.pdf，2.13.2节)，因此这两种情况改用中断方式接收。
+  * @参数   addr：7位从机地址
+  * @参数   buf：接收数据地址
+  * @参数   size：接收数据量
+  * @返回值 HAL状态
+  */
+HAL_StatusTypeDef BspI2cMasterReceiveDma(uint16_t addr, uint8_t *buf, uint16_t size)
+{
+	tx_dma_flag = 0;
+	if(size <= 2)
+	{
+		return HAL_I2C_Master_Receive_IT(I2C_MASTER, addr << 1, buf, size);
+	}
+	return HAL_I2C_Master_Receive_DMA(I2C_MASTER, addr << 1, buf, size);
+}
+
+/** 
+  * @描述   探测从机地址，只发送地址，不发送数据字节
+  * @参数   addr：7位从机地址
+  * @返回值 HAL_OK从机应答，其他为无应答或总线错误
+  */
+HAL_StatusTypeDef BspI2cProbe(uint16_t addr)
+{
+	return HAL_I2C_IsDeviceReady(I2C_MASTER, addr << 1, 1, 2);
+}
+
+/** 
+  * @描述   检测I2C总线是否卡死。空闲时SCL和SDA都应为高电平，且I2C模块不处于忙状态，
+  *         否则需要通过BspI2cResetBus恢复。引脚处于复用功能模式时，仍可从IDR读取电平。
+  * @参数   无
+  * @返回值 1总线卡死，0总线空闲
+  */
+uint8_t BspI2cBusStuck(void)
+{
+	if((GPIO_PIN_RESET == HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_10)) || (GPIO_PIN_RESET == HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_11)))
+	{
+		return 1;
+	}
+	if(__HAL_I2C_GET_FLAG(I2C_MASTER, I2C_FLAG_BUSY))
+	{
+		return 1;
+	}
+	return 0;
+}
+
+/** 
+  * @描述   判断最近一次因应答失败(AF)结束的传输是否在地址阶段就被拒绝。
+  *         没有任何数据字节被发出时为地址无应答，否则为数据无应答。主机接收时只可能是地址无应答。
+  *         DMA发送时HAL不更新XferCount，改用DMA通道的剩余数量判断，DMA中止后该数量保持不变。
+  * @参数   async：1最近一次传输为BspI2cMasterTransmitDma/BspI2cMasterReceiveDma，0为阻塞传输
+  * @返回值 1地址无应答，0数据无应答
+  */
+uint8_t BspI2cNackAtAddr(uint8_t async)
+{
+	if(!async)
+	{
+		return (I2C_MASTER->XferCount == I2C_MASTER->XferSize) ? 1 : 0;
+	}
+	if(!tx_dma_flag)
+	{
+		return 1;
+	}
+	return (__HAL_DMA_GET_COUNTER(I2C_MASTER->hdmatx) == I2C_MASTER->XferSize) ? 1 : 0;
+}
@@ -10,6 +10,11 @@
 
 #define I2C_MASTER        (&hi2c2)
 void BspI2cResetBus(void);
+HAL_StatusTypeDef BspI2cMasterTransmitDma(uint16_t addr, uint8_t *buf, uint16_t size);
+HAL_StatusTypeDef BspI2cMasterReceiveDma(uint16_t addr, uint8_t *buf, uint16_t size);
+HAL_StatusTypeDef BspI2cProbe(uint16_t addr);
+uint8_t BspI2cBusStuck(void);
+uint8_t BspI2cNackAtAddr(uint8_t async);
 
 #ifdef __cplusplus
 }
@@ -5,9 +5,20 @@
 
 #define UART_RX_BUF_SIZE 512
 
+// 接收环形缓冲：DMA循环模式连续写入，中断中累计写入的字节数，任务从读取位置开始直接在缓冲中解析。
+// rx_written和rx_read为累计写入和解析的字节数，对缓冲长度取余即为位置；二者之差超过缓冲长度说明DMA已覆盖未解析的数据
 uint8_t uart_pc_rx_buf[UART_RX_BUF_SIZE];
+static volatile uint16_t rx_head;
+static volatile uint32_t rx_written;
+static uint32_t rx_read;
+static uint32_t rx_overrun_cnt;
 
-extern Frame_HandlePtr hframe_pc;
+// 发送双缓冲：任务向填充缓冲追加数据，DMA发送另一个缓冲，发送完成中断中交换
+uint8_t           uart_pc_tx_buf[2][UART_TX_BUF_SIZE];
+static uint16_t   tx_len[2];
+static uint8_t    tx_fill;        // 当前填充缓冲的序号
+static volatile uint8_t tx_busy;  // DMA正在发送另一个缓冲
+static volatile uint32_t tx_drop_cnt;
 
 void BspUartInit(void)
 {
@@ -15,28 +26,321 @@ void BspUartInit(void)
 	HAL_UART_Receive_DMA(UART_PC, uart_pc_rx_buf, UART_RX_BUF_SIZE);
 }
 
+/** 
+  * @描述   接收DMA当前的写入位置
+  */
+static uint16_t rx_dma_head(void)
+{
+	uint16_t head = UART_RX_BUF_SIZE - __HAL_DMA_GET_COUNTER(UART_PC->hdmarx);
+	return (head >= UART_RX_BUF_SIZE) ? 0 : head;
+}
+
+/** 
+  * @描述   根据DMA写入位置的变化累计写入的字节数，在空闲、半满和全满中断中调用。
+  *         半满和全满中断保证两次调用之间DMA写入不超过半个缓冲，按位置差累计不会漏掉整圈。
+  * @参数   huart：串口句柄
+  * @返回值 无
+  */
+static void rx_publish(UART_HandleTypeDef *huart)
+{
+	uint16_t head = rx_dma_head();
+
+	(void)huart;
+	rx_written += (head + UART_RX_BUF_SIZE - rx_head) % UART_RX_BUF_SIZE;
+	rx_head = head;
+}
+
+/** 
+  * @描述   到当前为止DMA累计写入的字节数，包括上次中断之后写入的部分。在任务中调用。
+  */
+static uint32_t rx_written_now(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t written;
+
+	__disable_irq();
+	written = rx_written + (rx_dma_head() + UART_RX_BUF_SIZE - rx_head) % UART_RX_BUF_SIZE;
+	__set_PRIMASK(primask);
+	return written;
+}
+
+/** 
+  * @描述   接收缓冲中尚未解析的字节数。DMA已覆盖未解析的数据时计数，丢弃剩余数据，从最新的写入位置重新开始解析。
+  */
+static uint16_t rx_avail(void)
+{
+	uint32_t written = rx_written_now();
+
+	if(written - rx_read > UART_RX_BUF_SIZE)
+	{
+		rx_overrun_cnt++;
+		rx_read = written;
+	}
+	return (uint16_t)(written - rx_read);
+}
+
+/** 
+  * @描述   读取未解析数据中第offset个字节，不移动读取位置
+  */
+static uint8_t rx_peek(uint16_t offset)
+{
+	return uart_pc_rx_buf[(rx_read + offset) % UART_RX_BUF_SIZE];
+}
+
+/** 
+  * @描述   在接收环形缓冲中直接搜索PC下发的数据帧 | 帧头 | 帧长 | ID | 参数 | 校验 |，帧长为整帧的字节数，不检查校验。
+  *         找到时把这一帧复制到frame_buf，之前的无效数据被丢弃；数据帧不完整时保留，下次继续搜索。在任务中调用。
+  * @参数   head：帧头
+  * @参数   frame_buf：存放数据帧
+  * @参数   size：frame_buf的长度，帧长超过该长度的数据帧被视为无效数据
+  * @返回值 FRAME_OK找到一帧，FRAME_LESS没有完整的数据帧
+  */
+Frame_StatusEnum BspUartFrameSearch(uint8_t head, uint8_t *frame_buf, uint16_t size)
+{
+	uint16_t avail;
+
+	while((avail = rx_avail()) >= 2)
+	{
+		uint8_t len = rx_peek(1);
+
+		if((head != rx_peek(0)) || (len < 4) || (len > size))
+		{
+			rx_read++;
+			continue;
+		}
+		if(avail < len)
+		{
+			return FRAME_LESS;
+		}
+		for(uint16_t k = 0; k < len; k++)
+		{
+			frame_buf[k] = rx_peek(k);
+		}
+		if(rx_written_now() - rx_read > UART_RX_BUF_SIZE)
+		{
+			continue;  // 复制期间这一帧被DMA覆盖，由rx_avail计数并重新同步
+		}
+		rx_read += len;
+		return FRAME_OK;
+	}
+	return FRAME_LESS;
+}
+
+/** 
+  * @描述   接收DMA半满和全满回调，循环模式下DMA不停止，只更新写入位置
+  */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+	if(UART_PC == huart)
+	{
+		rx_publish(huart);
+	}
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+	if(UART_PC == huart)
+	{
+		rx_publish(huart);
+	}
+}
+
+/** 
+  * @描述   DMA空闲且填充缓冲有数据时，开始发送填充缓冲，并把另一个缓冲作为新的填充缓冲。须在关中断时调用。
+  * @参数   无
+  * @返回值 无
+  */
+static void tx_kick(void)
+{
+	uint8_t k = tx_fill;
+
+	if(tx_busy || (0 == tx_len[k]))
+	{
+		return;
+	}
+	if(HAL_OK != HAL_UART_Transmit_DMA(UART_PC, uart_pc_tx_buf[k], tx_len[k]))
+	{
+		return;  // 串口状态异常时保留数据，下一次写入或发送完成时再试
+	}
+	tx_busy       = 1;
+	tx_fill       = k ^ 1;
+	tx_len[k ^ 1] = 0;
+}
+
+/** 
+  * @描述   向PC发送数据，不阻塞：数据追加到填充缓冲，DMA空闲时立即开始发送。
+  *         填充缓冲放不下时整段丢弃并计数，不等待，避免拆散一帧数据。可以在任务和中断中调用。
+  * @参数   buf：数据
+  * @参数   len：数据长度
+  * @返回值 实际写入的长度，len或0
+  */
+uint16_t BspUartWrite(const uint8_t *buf, uint16_t len)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint16_t ret = len;
+
+	__disable_irq();
+	if(tx_len[tx_fill] + len > UART_TX_BUF_SIZE)
+	{
+		tx_drop_cnt += len;
+		ret = 0;
+	}
+	else
+	{
+		memcpy(&uart_pc_tx_buf[tx_fill][tx_len[tx_fill]], buf, len);
+		tx_len[tx_fill] += len;
+		tx_kick();
+	}
+	__set_PRIMASK(primask);
+	return ret;
+}
+
+/** 
+  * @描述   读取因发送缓冲满而丢弃的字节数
+  * @参数   无
+  * @返回值 丢弃的字节数
+  */
+uint32_t BspUartTxDropCount(void)
+{
+	return tx_drop_cnt;
+}
+
+/** 
+  * @描述   读取解析不及时、未解析的数据被接收DMA覆盖的次数
+  * @参数   无
+  * @返回值 覆盖次数
+  */
+uint32_t BspUartRxOverrunCount(void)
+{
+	return rx_overrun_cnt;
+}
+
+/** 
+  * @描述   等待发送缓冲中的数据全部发出，用于修改波特率之前。在任务中调用。
+  * @参数   timeout_ms：超时时间
+  * @返回值 HAL_OK全部发出，HAL_TIMEOUT超时
+  */
+HAL_StatusTypeDef BspUartTxFlush(uint32_t timeout_ms)
+{
+	uint32_t start = HAL_GetTick();
+
+	while(tx_busy || (tx_len[tx_fill] > 0))
+	{
+		if(!tx_busy)
+		{
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			tx_kick();
+			__set_PRIMASK(primask);
+		}
+		if(HAL_GetTick() - start >= timeout_ms)
+		{
+			return HAL_TIMEOUT;
+		}
+	}
+	return HAL_OK;
+}
+
+/** 
+  * @描述   计算波特率对应的BRR值。16倍过采样时BRR即为外设时钟与波特率之比，低4位为小数部分。
+  * @参数   pclk：串口的外设时钟
+  * @参数   baud：波特率
+  * @返回值 BRR值，0表示超出可设置的范围
+  */
+static uint32_t baud_brr(uint32_t pclk, uint32_t baud)
+{
+	uint32_t brr;
+
+	if(0 == baud)
+	{
+		return 0;
+	}
+	brr = (pclk + baud / 2) / baud;
+	return ((brr < 16) || (brr > 0xFFFF)) ? 0 : brr;
+}
+
+/** 
+  * @描述   计算一个波特率实际能达到的值和误差，不修改串口设置
+  * @参数   baud：期望的波特率
+  * @参数   err_ppm：实际波特率相对期望值的误差，单位百万分之一，可以为NULL
+  * @返回值 实际波特率，0表示超出范围，16倍过采样时最高为外设时钟的1/16
+  */
+uint32_t BspUartBaudCalc(uint32_t baud, int32_t *err_ppm)
+{
+	uint32_t pclk   = UART_PC_PCLK();
+	uint32_t brr    = baud_brr(pclk, baud);
+	uint32_t actual = (brr > 0) ? (pclk + brr / 2) / brr : 0;
+
+	if(NULL != err_ppm)
+	{
+		*err_ppm = (brr > 0) ? (int32_t)(((int64_t)actual - baud) * 1000000 / baud) : 0;
+	}
+	return actual;
+}
+
+/** 
+  * @描述   修改串口波特率，接收DMA继续运行。调用前应先用BspUartTxFlush发出缓冲中的数据。
+  * @参数   baud：波特率，须经BspUartBaudCalc确认在范围内
+  * @返回值 无
+  */
+void BspUartSetBaud(uint32_t baud)
+{
+	uint32_t brr = baud_brr(UART_PC_PCLK(), baud);
+	uint32_t primask = __get_PRIMASK();
+
+	if(0 == brr)
+	{
+		return;
+	}
+	__disable_irq();
+	__HAL_UART_DISABLE(UART_PC);
+	UART_PC->Instance->BRR = brr;
+	UART_PC->Init.BaudRate = baud;
+	__HAL_UART_ENABLE(UART_PC);
+	__set_PRIMASK(primask);
+}
+
+/** 
+  * @描述   读取当前设置的波特率
+  * @参数   无
+  * @返回值 波特率
+  */
+uint32_t BspUartGetBaud(void)
+{
+	return UART_PC->Init.BaudRate;
+}
+
+/** 
+  * @描述   printf的输出函数。写入发送缓冲后立即返回，不再逐字节阻塞等待发送完成。
+  */
 int stdout_putchar (int ch)
 {
-	HAL_UART_Transmit(UART_PC, (uint8_t*)&ch, 1, 10);
-	return 0;
+	uint8_t c = (uint8_t)ch;
+	(void)BspUartWrite(&c, 1);
+	return ch;
+}
+
+/** 
+  * @描述   串口发送完成回调，在串口中断中由UART_EndTransmit_IT调用。交换缓冲，继续发送已填充的数据。
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	if(UART_PC == huart)
+	{
+		tx_busy = 0;
+		tx_kick();
+	}
 }
 
 void BspUartRxIdleCallback(UART_HandleTypeDef *huart)
 {
 	uint32_t tmp_flag      = __HAL_UART_GET_FLAG     (huart, UART_FLAG_IDLE);
 	uint32_t tmp_it_source = __HAL_UART_GET_IT_SOURCE(huart, UART_IT_IDLE);
-	uint32_t len;
 
 	if ((RESET != tmp_flag) && (RESET != tmp_it_source))
 	{
 		__HAL_UART_CLEAR_IDLEFLAG(huart);
-		huart->gState = (HAL_UART_STATE_BUSY_TX_RX == huart->gState) ? HAL_UART_STATE_BUSY_TX : HAL_UART_STATE_READY;
-
-		__HAL_DMA_DISABLE(huart->hdmarx);
-		len = UART_RX_BUF_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx);
-		Frame_WriteFifo(hframe_pc, uart_pc_rx_buf, len);
-		huart->hdmarx->Instance->CNDTR = UART_RX_BUF_SIZE;
-		__HAL_DMA_ENABLE(huart->hdmarx);
+		rx_publish(huart);
 	}
 }
 
@@ -6,10 +6,21 @@
 #endif 
 
 #define UART_PC        (&huart2)
+#define UART_PC_PCLK() HAL_RCC_GetPCLK1Freq()  // USART2挂在APB1上
+#define UART_TX_BUF_SIZE 1024     // 每个发送缓冲的长度，共两个
 
 #include "usart.h"
+#include "frame.h"
 void BspUartInit(void);
+uint16_t BspUartWrite(const uint8_t *buf, uint16_t len);
+uint32_t BspUartTxDropCount(void);
+uint32_t BspUartRxOverrunCount(void);
+HAL_StatusTypeDef BspUartTxFlush(uint32_t timeout_ms);
+uint32_t BspUartBaudCalc(uint32_t baud, int32_t *err_ppm);
+void BspUartSetBaud(uint32_t baud);
+uint32_t BspUartGetBaud(void);
 void BspUartRxIdleCallback(UART_HandleTypeDef *huart);
+Frame_StatusEnum BspUartFrameSearch(uint8_t head, uint8_t *frame_buf, uint16_t size);
 void User_HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
 
 #ifdef __cplusplus
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @文件    tfminip_cmd.h
+  * @描述    tfmini plus指令帧定义
+  *
+  * 指令帧格式为 | 0x5A | len | id | payload | checksum |，checksum为前面所有字节之和的低8位。
+  * 不带参数的指令在编译期生成完整的常量帧，存放于flash，驱动直接从flash发送，无需在运行时构造，可重入。
+  * 带参数的指令以参数为0的常量帧为模板，复制后用MINIP_CMD_PATCH写入参数，校验和随参数增量修正。
+  ******************************************************************************
+  */
+
+#ifndef _TFMINIP_CMD_H
+#define _TFMINIP_CMD_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define MINIP_CMD_HEAD          (0x5A)   // 指令帧和配置应答帧的帧头
+
+/* 指令ID */
+#define MINIP_ID_DATA           (0x00)   // 获取数据帧
+#define MINIP_ID_VERSION        (0x01)   // 获取固件版本
+#define MINIP_ID_SOFT_RESET     (0x02)   // 软件复位
+#define MINIP_ID_SAMPLE_RATE    (0x03)   // 帧率
+#define MINIP_ID_SAMPLE_TRIG    (0x04)   // 单次触发
+#define MINIP_ID_OUTPUT_EN      (0x07)   // 使能/关闭输出
+#define MINIP_ID_SLAVE_ADDR     (0x0B)   // I2C从机地址
+#define MINIP_ID_RESTORE        (0x10)   // 恢复出厂设置
+#define MINIP_ID_SAVE           (0x11)   // 保存设置
+#define MINIP_ID_AMP_TH         (0x22)   // AMP阈值
+#define MINIP_ID_TIMESTAMP      (0x31)   // 时间戳同步
+#define MINIP_ID_DIST_LIMIT     (0x3A)   // 距离限制
+#define MINIP_ID_GET            (0x3F)   // 读取配置，应答帧的ID为被读取的配置项ID
+
+#define MINIP_DATA_FMT_TICK     (0x07)   // 获取数据帧的格式参数：距离、AMP和时间戳
+
+/* 编译期生成指令帧，参数必须为常量表达式 */
+#define MINIP_CMD4(id) \
+	{MINIP_CMD_HEAD, 4, (id), (uint8_t)(MINIP_CMD_HEAD + 4 + (id))}
+#define MINIP_CMD5(id, p0) \
+	{MINIP_CMD_HEAD, 5, (id), (p0), (uint8_t)(MINIP_CMD_HEAD + 5 + (id) + (p0))}
+#define MINIP_CMD6(id, p0, p1) \
+	{MINIP_CMD_HEAD, 6, (id), (p0), (p1), (uint8_t)(MINIP_CMD_HEAD + 6 + (id) + (p0) + (p1))}
+#define MINIP_CMD8(id, p0, p1, p2, p3) \
+	{MINIP_CMD_HEAD, 8, (id), (p0), (p1), (p2), (p3), (uint8_t)(MINIP_CMD_HEAD + 8 + (id) + (p0) + (p1) + (p2) + (p3))}
+#define MINIP_CMD9(id, p0, p1, p2, p3, p4) \
+	{MINIP_CMD_HEAD, 9, (id), (p0), (p1), (p2), (p3), (p4), (uint8_t)(MINIP_CMD_HEAD + 9 + (id) + (p0) + (p1) + (p2) + (p3) + (p4))}
+
+/* 向由模板复制得到的指令帧写入一个参数字节，模板中该字节必须为0，校验和(帧的最后一个字节)随之修正。
+   MINIP_CMD_PATCH的cmd须为数组，cmd为指针时使用MINIP_CMD_PATCH_LEN并给出帧长度 */
+#define MINIP_CMD_PATCH_LEN(cmd, len, pos, val) \
+	do { (cmd)[pos] = (uint8_t)(val); (cmd)[(len) - 1] += (uint8_t)(val); } while(0)
+#define MINIP_CMD_PATCH(cmd, pos, val) \
+	MINIP_CMD_PATCH_LEN(cmd, sizeof(cmd), pos, val)
+
+/* 常量指令帧 */
+static const uint8_t minip_cmd_read_data[5]        = MINIP_CMD5(MINIP_ID_DATA, MINIP_DATA_FMT_TICK);
+static const uint8_t minip_cmd_read_version[4]     = MINIP_CMD4(MINIP_ID_VERSION);
+static const uint8_t minip_cmd_soft_reset[4]       = MINIP_CMD4(MINIP_ID_SOFT_RESET);
+static const uint8_t minip_cmd_sample_trig[4]      = MINIP_CMD4(MINIP_ID_SAMPLE_TRIG);
+static const uint8_t minip_cmd_enable[5]           = MINIP_CMD5(MINIP_ID_OUTPUT_EN, 1);
+static const uint8_t minip_cmd_disable[5]          = MINIP_CMD5(MINIP_ID_OUTPUT_EN, 0);
+static const uint8_t minip_cmd_restore_default[4]  = MINIP_CMD4(MINIP_ID_RESTORE);
+static const uint8_t minip_cmd_save_settings[4]    = MINIP_CMD4(MINIP_ID_SAVE);
+static const uint8_t minip_cmd_get_sample_rate[5]  = MINIP_CMD5(MINIP_ID_GET, MINIP_ID_SAMPLE_RATE);
+static const uint8_t minip_cmd_get_status[5]       = MINIP_CMD5(MINIP_ID_GET, MINIP_ID_OUTPUT_EN);
+static const uint8_t minip_cmd_get_amp_th[5]       = MINIP_CMD5(MINIP_ID_GET, MINIP_ID_AMP_TH);
+static const uint8_t minip_cmd_get_dist_limit[5]   = MINIP_CMD5(MINIP_ID_GET, MINIP_ID_DIST_LIMIT);
+
+/* 带参数指令的模板，参数字节为0 */
+static const uint8_t minip_cmd_set_sample_rate[6]  = MINIP_CMD6(MINIP_ID_SAMPLE_RATE, 0, 0);
+static const uint8_t minip_cmd_set_slave_addr[5]   = MINIP_CMD5(MINIP_ID_SLAVE_ADDR, 0);
+static const uint8_t minip_cmd_set_amp_th[5]       = MINIP_CMD5(MINIP_ID_AMP_TH, 0);
+static const uint8_t minip_cmd_timestamp[8]        = MINIP_CMD8(MINIP_ID_TIMESTAMP, 0, 0, 0, 0);
+static const uint8_t minip_cmd_set_dist_limit[9]   = MINIP_CMD9(MINIP_ID_DIST_LIMIT, 0, 0, 0, 0, 0);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,497 +1,2553 @@
 #include "tfminip_i2c_driver.h"
+#include "tfminip_cmd.h"
+#include "tfminip_trace.h"
 #include "string.h"
 
 #ifndef NULL
 	#define NULL ((void*)0)
 #endif
 
-static I2cWriteFuncPtr     i2c_write_func = NULL;
-static I2cReadFuncPtr      i2c_read_func  = NULL;
-static I2cBusResetFuncPtr  i2c_reset_func = NULL;
-static DelayMsFuncPtr      delay_ms_func  = NULL;
-static MinipDevListStruct  sDevList;         // 总线上的MINIP从机地址列表
-static MinipDevListStruct  sDevListEx;       // 需要排除的其他设备的从机地址列表
-static uint8_t             sInitFlag = 0;
+#define MINIP_DATA_HEAD    (0x59)   // 测距结果应答帧的两个帧头字节
+#define MINIP_DATA_LEN     (11)     // 测距结果应答帧长度
+
+static MinipBus sDefaultBus;   // 单总线接口使用的默认总线
 
 /** 
-  * @描述   I2C发收结合函数
+  * @描述   记录一次事务的结果，分别计入总线和从机地址的累计次数。地址统计表已满时只计入总线。
+  * @参数   bus：总线句柄
   * @参数   addr：从机地址
-  * @参数   cmd_buf：发送数据地址
-  * @参数   cmd_len：发送数据长度
-  * @参数   ack_buf：接收数据地址
-  * @参数   ack_len：接收数据长度
-  * @参数   wait_time：数据发送和接收间隔
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @参数   status：事务结果
+  * @返回值 无
   */
-static uint8_t i2c_transcieve(uint8_t addr, uint8_t *cmd_buf, uint8_t cmd_len, uint8_t *ack_buf, uint8_t ack_len, uint32_t wait_time)
+static void stat_record(MinipBus *bus, uint8_t addr, uint8_t status)
 {
-	if(!sInitFlag)
+	uint8_t k;
+
+	if(status >= MINIP_STATUS_NUM)
 	{
-		return I2C_ERROR;
+		status = I2C_ERROR;
 	}
+	bus->status_cnt[status]++;
 
-	if(I2C_OK == i2c_write_func(addr, cmd_buf, cmd_len))
+	for(k = 0; k < bus->stat_num; k++)
 	{
-		delay_ms_func(wait_time);
-		if(I2C_OK == i2c_read_func(addr, ack_buf, ack_len))
-		{
-			return I2C_OK;
-		}
-		else
+		if(addr == bus->stat[k].addr)
 		{
-			return I2C_ERROR;
+			break;
 		}
 	}
-	else
+	if(k == bus->stat_num)
 	{
-		return I2C_ERROR;
+		if(bus->stat_num >= MINIP_MAX_DEV)
+		{
+			return;
+		}
+		memset(&bus->stat[k], 0, sizeof(MinipAddrStatStruct));
+		bus->stat[k].addr = addr;
+		bus->stat_num++;
 	}
+	bus->stat[k].status_cnt[status]++;
 }
 
 /** 
-  * @描述   判断一个从机地址是否存在于指定的地址列表中
-  * @参数   addr：待判断的从机地址
-  * @参数   list：指定的地址列表
-  * @返回值 存在返回1，不存在返回0
+  * @描述   复位总线，并记录复位用时
+  * @参数   bus：总线句柄
+  * @返回值 无
   */
-static uint8_t is_addr_in_list(uint8_t addr, MinipDevListStruct list)
+static void bus_reset(MinipBus *bus)
 {
-	for(uint8_t n = 0; n < list.num; n++)
-	{
-		if(addr == list.addr_list[n])
-		{
-			return 1;
-		}
-	}
-	return 0;
+	uint32_t start = MinipPerfNow(&bus->perf);
+	MINIP_TRACE_RESET();
+	bus->i2c_reset_func();
+	MinipPerfRecordReset(&bus->perf, MinipPerfElapsedUs(&bus->perf, start, MinipPerfNow(&bus->perf)));
 }
 
 /** 
-  * @描述   I2C初始化函数，注册访问i2c总线必要的函数指针
-  * @参数   i2c_write：I2C写函数指针
-  * @参数   i2c_read：I2C读函数指针
-  * @参数   i2c_reset：I2C总线复位函数指针
-  * @参数   delay_ms：延时函数指针
+  * @描述   将一次成功事务的各阶段用时计入延时直方图
+  * @参数   bus：总线句柄
+  * @参数   xfer：已结束的事务
   * @返回值 无
   */
-void MinipI2cInit(I2cWriteFuncPtr i2c_write, I2cReadFuncPtr i2c_read, I2cBusResetFuncPtr i2c_reset, DelayMsFuncPtr delay_ms)
+static void perf_record_xfer(MinipBus *bus, MinipXferStruct *xfer)
 {
-	if(!(i2c_write && i2c_read && i2c_reset && delay_ms))
+	MinipPerfStruct *perf = &bus->perf;
+
+	if(xfer->cmd_len > 0)
 	{
-		return;
+		MinipPerfRecord(perf, xfer->addr, MINIP_PHASE_WRITE, MinipPerfElapsedUs(perf, xfer->tick_start, xfer->tick_write));
+	}
+	if(xfer->ack_len > 0)
+	{
+		if(xfer->cmd_len > 0)
+		{
+			MinipPerfRecord(perf, xfer->addr, MINIP_PHASE_WAIT, MinipPerfElapsedUs(perf, xfer->tick_write, xfer->tick_read));
+		}
+		MinipPerfRecord(perf, xfer->addr, MINIP_PHASE_READ, MinipPerfElapsedUs(perf, xfer->tick_read, xfer->tick_done));
 	}
-	i2c_write_func = i2c_write;
-	i2c_read_func  = i2c_read;
-	i2c_reset_func = i2c_reset;
-	delay_ms_func  = delay_ms;
-	memset(&sDevList,   0, sizeof(MinipDevListStruct));
-	memset(&sDevListEx, 0, sizeof(MinipDevListStruct));
-	sInitFlag = 1;
 }
 
 /** 
-  * @描述   I2C总线设备查询函数
-  * @参数   无
-  * @返回值 I2C总线上的设备列表
+  * @描述   执行一次完整的总线事务。总线注册了异步函数时，提交事务后阻塞等待中断完成；否则使用阻塞方式读写。
+  * @参数   bus：总线句柄
+  * @参数   xfer：事务描述符
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
   */
-MinipDevListStruct MinipI2cScanBus(void)
+static uint8_t i2c_xfer(MinipBus *bus, MinipXferStruct *xfer)
 {
-	memset(&sDevList, 0, sizeof(MinipDevListStruct));
-	if(!sInitFlag)
+	uint8_t status;
+
+	if(!bus->init_flag)
 	{
-		return sDevList;
+		return I2C_NOT_INIT;
 	}
-	
-	uint8_t dummy = 0xFF;
-	i2c_reset_func();
-	for(uint8_t n = 1; n <= 127; n++)
+
+	bus->xfer_cnt++;
+	MINIP_TRACE_XFER_BEGIN(xfer->addr, (xfer->cmd_len > 2) ? xfer->cmd_buf[2] : 0xFF);
+	if(NULL != bus->i2c_write_it_func)
 	{
-		// 跳过排除列表中的地址
-		if(is_addr_in_list(n, sDevListEx))
+		status = MinipBusXferSubmit(bus, xfer);
+		if(I2C_OK == status)
 		{
-			continue;
+			status = MinipBusXferWait(bus, xfer, MINIP_XFER_TIMEOUT_MS);
 		}
-
-		if(I2C_OK == i2c_write_func(n, &dummy, 1))
+	}
+	else
+	{
+		status = I2C_OK;
+		xfer->tick_start = MinipPerfNow(&bus->perf);
+		if(xfer->cmd_len > 0)
 		{
-			sDevList.addr_list[sDevList.num] = n;
-			sDevList.num++;
+			status = bus->i2c_write_func(xfer->addr, (uint8_t*)xfer->cmd_buf, xfer->cmd_len);
 		}
-		else
+		xfer->tick_write = MinipPerfNow(&bus->perf);
+		xfer->tick_read  = xfer->tick_write;
+		if((I2C_OK == status) && (xfer->ack_len > 0))
 		{
-			i2c_reset_func();
+			bus->delay_ms_func(xfer->wait_time);
+			xfer->tick_read = MinipPerfNow(&bus->perf);
+			status = bus->i2c_read_func(xfer->addr, xfer->ack_buf, xfer->ack_len);
 		}
+		xfer->tick_done = MinipPerfNow(&bus->perf);
 	}
 
-	return sDevList;
+	if(I2C_OK == status)
+	{
+		perf_record_xfer(bus, xfer);
+	}
+	stat_record(bus, xfer->addr, status);
+	MINIP_TRACE_XFER_DONE(xfer->addr, (xfer->cmd_len > 2) ? xfer->cmd_buf[2] : 0xFF, status);
+	return status;
 }
 
 /** 
-  * @描述   执行一次动态地址分配操作，使用方法为：总线上新接入一台雷达，调用一次此函数。
-  *         维护一个总线上的雷达列表，列表中的雷达从机地址均不相同，范围[1, 127]。
-  *         当函数调用时，发现总线上有一台默认从机地址的雷达时，将为该雷达分配一个新的地址，并加入所维护的雷达列表中。
-  * @参数   default_addr：雷达的默认从机地址
-  * @返回值 无
+  * @描述   I2C写函数
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   cmd_buf：发送数据地址
+  * @参数   cmd_len：发送数据长度
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
   */
-MinipDevListStruct MinipAddrDynamicAllocation(uint8_t default_addr)
+static uint8_t i2c_write(MinipBus *bus, uint8_t addr, const uint8_t *cmd_buf, uint8_t cmd_len)
 {
-	sDevList = MinipI2cScanBus();
-	// 检查当前的地址列表中是否有默认地址
-	if(is_addr_in_list(default_addr, sDevList))
-	{
-		// 寻找一个地址，不在当前地址列表、不在排除地址列表、不是默认地址
-		for(uint8_t n = 1; n <= 127; n++)
-		{
-			if((0 == is_addr_in_list(n, sDevList)) && (0 == is_addr_in_list(n, sDevListEx)) && (n != default_addr))
-			{
-				(void)MinipSetSlaveAddr(default_addr, n);
-				sDevList = MinipI2cScanBus();  // 修改从机地址后，重新扫描一次总线。
-			}
-		}
-	}
-	return sDevList;
+	MinipXferStruct xfer = {0};
+
+	xfer.addr    = addr;
+	xfer.cmd_buf = cmd_buf;
+	xfer.cmd_len = cmd_len;
+	return i2c_xfer(bus, &xfer);
 }
 
 /** 
-  * @描述   添加从机地址的排除列表。由于I2C总线上可能挂着除TFMINI PLUS之外的设备，因此操作总线时，排除这些设备的地址
-  * @参数   num：排除地址的个数
-  * @参数   ex_list：排除地址的列表，uint8_t型的数组
-  * @返回值 无
+  * @描述   I2C发收结合函数
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   cmd_buf：发送数据地址
+  * @参数   cmd_len：发送数据长度
+  * @参数   ack_buf：接收数据地址
+  * @参数   ack_len：接收数据长度
+  * @参数   wait_time：数据发送和接收间隔
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
   */
-void MinipAddrExclude(uint8_t num, uint8_t *ex_list)
+static uint8_t i2c_transcieve(MinipBus *bus, uint8_t addr, const uint8_t *cmd_buf, uint8_t cmd_len, uint8_t *ack_buf, uint8_t ack_len, uint32_t wait_time)
 {
-	memset(&sDevListEx, 0, sizeof(MinipDevListStruct));
-	memcpy(sDevListEx.addr_list, ex_list, num * sizeof(uint8_t));
-	sDevListEx.num = num;
+	MinipXferStruct xfer = {0};
+
+	xfer.addr      = addr;
+	xfer.cmd_buf   = cmd_buf;
+	xfer.cmd_len   = cmd_len;
+	xfer.ack_buf   = ack_buf;
+	xfer.ack_len   = ack_len;
+	xfer.wait_time = wait_time;
+	return i2c_xfer(bus, &xfer);
 }
 
 /** 
-  * @描述   读取雷达测距结果函数
-  * @参数   addr：指定雷达的从机地址
-  * @参数   data：测距结果结构体指针
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   I2C读函数，只读取雷达已准备好的应答，不发送指令
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   ack_buf：接收数据地址
+  * @参数   ack_len：接收数据长度
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
   */
-uint8_t MinipReadData(uint8_t addr, MinipDataStruct *data)
+static uint8_t i2c_read(MinipBus *bus, uint8_t addr, uint8_t *ack_buf, uint8_t ack_len)
 {
-	static uint8_t cmd[5] = {0x5A, 5, 0x00, 0x07, 0};
-	static uint8_t ack[11];
-	if(I2C_OK == i2c_transcieve(addr, cmd, 5, ack, 11, 0))
-	{
-		data->dist = (uint16_t)ack[2] + (((uint16_t)ack[3]) << 8);
-		data->amp  = (uint16_t)ack[4] + (((uint16_t)ack[5]) << 8);
-		data->tick_ms = (uint32_t)ack[6] + (((uint32_t)ack[7]) << 8) + (((uint32_t)ack[8]) << 16) + (((uint32_t)ack[9]) << 24);
-		return I2C_OK;
-	}
-	else
+	MinipXferStruct xfer = {0};
+
+	xfer.addr    = addr;
+	xfer.ack_buf = ack_buf;
+	xfer.ack_len = ack_len;
+	return i2c_xfer(bus, &xfer);
+}
+
+/** 
+  * @描述   计算校验和
+  * @参数   buf：数据地址
+  * @参数   len：数据长度
+  * @返回值 所有字节之和的低8位
+  */
+static uint8_t cal_sum(uint8_t *buf, uint8_t len)
+{
+	uint8_t sum = 0;
+	for(uint8_t n = 0; n < len; n++)
 	{
-		return I2C_ERROR;
+		sum += buf[n];
 	}
+	return sum;
 }
 
 /** 
-  * @描述   读取雷达固件版本号函数
-  * @参数   addr：指定雷达的从机地址
-  * @参数   verion：固件版本号结构体指针
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   校验配置应答帧，格式为 | 0x5A | len | id | payload | checksum |
+  * @参数   ack：应答帧
+  * @参数   len：应答帧长度
+  * @参数   id：期望的应答ID
+  * @返回值 I2C_OK或I2C_FRAME_ERROR
   */
-uint8_t MinipReadVersion(uint8_t addr, MinipFirmwareVersion *verion)
+static uint8_t check_ack_frame(uint8_t *ack, uint8_t len, uint8_t id)
 {
-	uint8_t cmd[4] = {0x5A, 4, 0x01, 0};
-	uint8_t ack[7];
-	if(I2C_OK == i2c_transcieve(addr, cmd, 4, ack, 7, 10))
+	if((MINIP_CMD_HEAD == ack[0]) && (len == ack[1]) && (id == ack[2]) && (cal_sum(ack, len - 1) == ack[len - 1]))
 	{
-		verion->major = ack[5];
-		verion->minor = ack[4];
-		verion->revision = ack[3];
 		return I2C_OK;
 	}
-	else
+	return I2C_FRAME_ERROR;
+}
+
+/** 
+  * @描述   校验测距结果应答帧，格式为 | 0x59 | 0x59 | dist | amp | tick | checksum |
+  * @参数   ack：应答帧
+  * @返回值 I2C_OK或I2C_FRAME_ERROR
+  */
+static uint8_t check_data_frame(uint8_t *ack)
+{
+	if((MINIP_DATA_HEAD == ack[0]) && (MINIP_DATA_HEAD == ack[1]) && (cal_sum(ack, MINIP_DATA_LEN - 1) == ack[MINIP_DATA_LEN - 1]))
 	{
-		return I2C_ERROR;
+		return I2C_OK;
 	}
+	return I2C_FRAME_ERROR;
 }
 
 /** 
-  * @描述   软件复位雷达函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   校验并解析测距结果应答帧，直接从接收缓存解析到输出结构，不做中间拷贝
+  * @参数   bus：总线句柄
+  * @参数   addr：应答帧来自的从机地址
+  * @参数   ack：应答帧
+  * @参数   data：测距结果结构体指针，校验失败时不修改
+  * @返回值 I2C_OK或I2C_FRAME_ERROR
   */
-uint8_t  MinipSoftReset(uint8_t addr)
+static uint8_t decode_data(MinipBus *bus, uint8_t addr, uint8_t *ack, MinipDataStruct *data)
 {
-	if(!sInitFlag)
+	if(I2C_OK != check_data_frame(ack))
 	{
-		return I2C_ERROR;
+		stat_record(bus, addr, I2C_FRAME_ERROR);
+		return I2C_FRAME_ERROR;
 	}
+	data->dist = (uint16_t)ack[2] + (((uint16_t)ack[3]) << 8);
+	data->amp  = (uint16_t)ack[4] + (((uint16_t)ack[5]) << 8);
+	data->tick_ms = (uint32_t)ack[6] + (((uint32_t)ack[7]) << 8) + (((uint32_t)ack[8]) << 16) + (((uint32_t)ack[9]) << 24);
+	return I2C_OK;
+}
 
-	uint8_t cmd[4] = {0x5A, 4, 0x02, 0};
-	return i2c_write_func(addr, cmd, 4);
+/** 
+  * @描述   结束当前异步事务并唤醒等待的任务
+  * @参数   bus：总线句柄
+  * @参数   xfer：当前事务
+  * @参数   status：事务结果
+  * @返回值 无
+  */
+static void xfer_finish(MinipBus *bus, MinipXferStruct *xfer, uint8_t status)
+{
+	xfer->tick_done = MinipPerfNow(&bus->perf);
+	bus->xfer    = NULL;
+	xfer->status = status;
+	xfer->state  = MINIP_XFER_DONE;
 }
 
 /** 
-  * @描述   设定雷达帧率函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @参数   rate：帧率，范围1-1000，雷达可实现的帧率为1000/n，n为正整数。当rate为0时，雷达进入单次触发模式
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   计算32位数最低位的1的位置
+  * @参数   x：不为0的32位数
+  * @返回值 最低位的1的位置，0~31
   */
-uint8_t  MinipSetSampleRate(uint8_t addr, uint16_t rate)
+static uint8_t ctz32(uint32_t x)
 {
-	if(!sInitFlag)
+	static const uint8_t debruijn_pos[32] = 
 	{
-		return I2C_ERROR;
-	}
+		0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+		31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+	};
+	return debruijn_pos[(uint32_t)((x & (0U - x)) * 0x077CB531U) >> 27];
+}
 
-	uint8_t cmd[6] = {0x5A, 6, 0x03, 0, 0, 0};
-	cmd[3] = rate & 0xFF;
-	cmd[4] = (rate >> 8) & 0xFF;
-	return i2c_write_func(addr, cmd, 6);
+/** 
+  * @描述   清空从机地址集合
+  * @参数   set：地址集合
+  * @返回值 无
+  */
+void MinipAddrSetClear(MinipAddrSetStruct *set)
+{
+	memset(set, 0, sizeof(MinipAddrSetStruct));
 }
 
 /** 
-  * @描述   读取雷达帧率函数。
-  * @参数   addr：指定雷达的从机地址
-  * @参数   rate：帧率指针
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   判断一个从机地址是否在集合中
+  * @参数   set：地址集合
+  * @参数   addr：待判断的从机地址
+  * @返回值 存在返回1，不存在返回0
   */
-uint8_t MinipGetSampleRate(uint8_t addr, uint16_t *rate)
+uint8_t MinipAddrSetContains(const MinipAddrSetStruct *set, uint8_t addr)
 {
-	uint8_t cmd[5] = {0x5A, 5, 0x3F, 0x03, 0};
-	uint8_t ack[6];
-	if(I2C_OK == i2c_transcieve(addr, cmd, 5, ack, 6, 10))
-	{
-		*rate = (uint16_t)ack[3] + (((uint16_t)ack[4]) << 8);
-		return I2C_OK;
-	}
-	else
-	{
-		return I2C_ERROR;
-	}
+	return (set->bits[(addr >> 5) & 3] >> (addr & 31)) & 1;
 }
 
 /** 
-  * @描述   对雷达进行单次触发函数，只有当雷达帧率为0，即单次触发模式下，此函数才有效
-  * @参数   addr：指定雷达的从机地址
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   将从机地址加入集合
+  * @参数   set：地址集合
+  * @参数   addr：从机地址
+  * @返回值 无
   */
-uint8_t  MinipSampleTrig(uint8_t addr)
+void MinipAddrSetInsert(MinipAddrSetStruct *set, uint8_t addr)
 {
-	if(!sInitFlag)
-	{
-		return I2C_ERROR;
-	}
+	set->bits[(addr >> 5) & 3] |= 1UL << (addr & 31);
+}
 
-	uint8_t cmd[4] = {0x5A, 4, 0x04, 0};
-	return i2c_write_func(addr, cmd, 4);
+/** 
+  * @描述   将从机地址移出集合
+  * @参数   set：地址集合
+  * @参数   addr：从机地址
+  * @返回值 无
+  */
+void MinipAddrSetRemove(MinipAddrSetStruct *set, uint8_t addr)
+{
+	set->bits[(addr >> 5) & 3] &= ~(1UL << (addr & 31));
 }
 
 /** 
-  * @描述   使能雷达函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   查找集合中没有的最小从机地址，范围[1, 127]，地址0为广播地址，不参与查找
+  * @参数   set：地址集合
+  * @返回值 找到的从机地址，全部被占用时返回0
   */
-uint8_t  MinipEnable(uint8_t addr)
+uint8_t MinipAddrSetFindFree(const MinipAddrSetStruct *set)
 {
-	if(!sInitFlag)
+	for(uint8_t w = 0; w < 4; w++)
 	{
-		return I2C_ERROR;
+		uint32_t free_bits = ~set->bits[w];
+		if(0 == w)
+		{
+			free_bits &= ~1UL;
+		}
+		if(0 != free_bits)
+		{
+			return (w << 5) + ctz32(free_bits);
+		}
 	}
-
-	uint8_t cmd[5] = {0x5A, 5, 0x07, 1, 0};
-	return i2c_write_func(addr, cmd, 5);
+	return 0;
 }
 
 /** 
-  * @描述   关闭雷达函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   将地址集合按从小到大的顺序展开为地址列表
+  * @参数   set：地址集合
+  * @参数   list：地址列表，由调用者提供
+  * @返回值 列表中的地址个数
   */
-uint8_t  MinipDisable(uint8_t addr)
+uint8_t MinipAddrSetToList(const MinipAddrSetStruct *set, MinipDevListStruct *list)
 {
-	if(!sInitFlag)
+	list->num = 0;
+	for(uint8_t w = 0; w < 4; w++)
 	{
-		return I2C_ERROR;
+		uint32_t bits = set->bits[w];
+		if(0 == w)
+		{
+			bits &= ~1UL;
+		}
+		while(0 != bits)
+		{
+			list->addr_list[list->num++] = (w << 5) + ctz32(bits);
+			bits &= bits - 1;
+		}
 	}
-
-	uint8_t cmd[5] = {0x5A, 5, 0x07, 0, 0};
-	return i2c_write_func(addr, cmd, 5);
+	return list->num;
 }
 
 /** 
-  * @描述   获取雷达状态函数
-  * @参数   addr：指定雷达的从机地址
-  * @参数   status：状态指针，0雷达关闭，1雷达使能
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   将[first, last]范围内的从机地址全部加入集合
+  * @参数   set：地址集合
+  * @参数   first：起始地址
+  * @参数   last：结束地址，不大于127
+  * @返回值 无
   */
-uint8_t  MinipGetStatus(uint8_t addr, uint8_t *status)
+void MinipAddrSetInsertRange(MinipAddrSetStruct *set, uint8_t first, uint8_t last)
 {
-	uint8_t cmd[5] = {0x5A, 5, 0x3F, 0x07, 0};
-	uint8_t ack[5];
-	if(I2C_OK == i2c_transcieve(addr, cmd, 5, ack, 5, 10))
+	for(uint8_t n = first; (n <= last) && (n <= 127); n++)
 	{
-		*status = ack[3];
-		return I2C_OK;
+		MinipAddrSetInsert(set, n);
 	}
-	else
+}
+
+/** 
+  * @描述   统计集合中的从机地址个数，地址0不计入
+  * @参数   set：地址集合
+  * @返回值 地址个数
+  */
+static uint8_t addr_set_count(const MinipAddrSetStruct *set)
+{
+	uint8_t num = 0;
+	for(uint8_t w = 0; w < 4; w++)
 	{
-		return I2C_ERROR;
+		uint32_t bits = (0 == w) ? (set->bits[w] & ~1UL) : set->bits[w];
+		while(0 != bits)
+		{
+			bits &= bits - 1;
+			num++;
+		}
 	}
+	return num;
 }
 
 /** 
-  * @描述   修改雷达从机地址函数
-  * @参数   addr：指定雷达的从机地址
-  * @参数   new_addr：新的从机地址，范围1-127
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   探测一个从机地址是否有设备应答。注册了地址探测函数时只发送地址；否则写一个0xFF字节。
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @返回值 I2C_OK有应答，否则为详细错误状态
   */
-uint8_t  MinipSetSlaveAddr(uint8_t addr, uint8_t new_addr)
+static uint8_t probe_addr(MinipBus *bus, uint8_t addr)
 {
-	if(!sInitFlag)
+	uint8_t dummy = 0xFF;
+	if(NULL != bus->i2c_probe_func)
 	{
-		return I2C_ERROR;
+		return bus->i2c_probe_func(addr);
 	}
-
-	uint8_t cmd[5] = {0x5A, 5, 0x0B, 0, 0};
-	cmd[3] = new_addr;
-	return i2c_write_func(addr, cmd, 5);
+	return bus->i2c_write_func(addr, &dummy, 1);
 }
 
 /** 
-  * @描述   恢复出厂设置函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   扫描过程中按需恢复总线。注册了卡死检测函数时，只有总线确实卡死才复位；
+  *         否则在旧的写字节探测方式下每次都复位，地址探测方式下不复位。
+  * @参数   bus：总线句柄
+  * @返回值 无
   */
-uint8_t  MinipRestoreDefault(uint8_t addr)
+static void scan_recover(MinipBus *bus)
 {
-	if(!sInitFlag)
+	if(NULL != bus->i2c_stuck_func)
+	{
+		if(bus->i2c_stuck_func())
+		{
+			bus_reset(bus);
+		}
+	}
+	else if(NULL == bus->i2c_probe_func)
 	{
-		return I2C_ERROR;
+		bus_reset(bus);
 	}
-
-	uint8_t cmd[4] = {0x5A, 4, 0x10, 0};
-	return i2c_write_func(addr, cmd, 4);
 }
 
 /** 
-  * @描述   保存当前设置函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   总线初始化函数，注册访问i2c总线必要的函数指针，并清空总线的设备列表、排除列表和计数
+  * @参数   bus：总线句柄
+  * @参数   i2c_write：I2C写函数指针
+  * @参数   i2c_read：I2C读函数指针
+  * @参数   i2c_reset：I2C总线复位函数指针
+  * @参数   delay_ms：延时函数指针
+  * @返回值 无
   */
-uint8_t  MinipSaveSettings(uint8_t addr)
+void MinipBusInit(MinipBus *bus, I2cWriteFuncPtr i2c_write, I2cReadFuncPtr i2c_read, I2cBusResetFuncPtr i2c_reset, DelayMsFuncPtr delay_ms)
 {
-	if(!sInitFlag)
+	if(!(bus && i2c_write && i2c_read && i2c_reset && delay_ms))
 	{
-		return I2C_ERROR;
+		return;
 	}
-
-	uint8_t cmd[4] = {0x5A, 4, 0x11, 0};
-	return i2c_write_func(addr, cmd, 4);
+	memset(bus, 0, sizeof(MinipBus));
+	bus->i2c_write_func = i2c_write;
+	bus->i2c_read_func  = i2c_read;
+	bus->i2c_reset_func = i2c_reset;
+	bus->delay_ms_func  = delay_ms;
+	MinipPerfInit(&bus->perf, NULL, 1);   // 未调用MinipBusTimingInit时不统计，也不会除以0
+	bus->init_flag = 1;
 }
 
 /** 
-  * @描述   设置雷达AMP阈值函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @参数   amp_th：AMP踢点阈值，数值为实际AMP阈值的10分之1，即实际阈值为amp_th*10，AMP低于该值时，距离值输出为0
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   注册异步访问总线的函数，注册后所有Minip*事务都通过中断完成，调用任务在事务进行期间阻塞而不占用CPU。
+  *         须在MinipBusInit之后调用，任一参数为NULL时恢复为阻塞方式。总线扫描仍使用MinipBusInit注册的阻塞函数。
+  * @参数   bus：总线句柄
+  * @参数   i2c_write_it：异步写启动函数，启动传输后立即返回，传输结束时须调用MinipBusXferCpltHandler
+  * @参数   i2c_read_it：异步读启动函数，要求同上
+  * @参数   notify：事务完成通知函数，在中断中调用
+  * @参数   wait：事务等待函数，在任务中调用
+  * @返回值 无
   */
-uint8_t  MinipSetAmpThreshold(uint8_t addr, uint8_t amp_th)
+void MinipBusAsyncInit(MinipBus *bus, I2cWriteFuncPtr i2c_write_it, I2cReadFuncPtr i2c_read_it, XferNotifyFuncPtr notify, XferWaitFuncPtr wait)
 {
-	if(!sInitFlag)
+	if(!(i2c_write_it && i2c_read_it && notify && wait))
 	{
-		return I2C_ERROR;
+		i2c_write_it = NULL;
+		i2c_read_it  = NULL;
+		notify       = NULL;
+		wait         = NULL;
 	}
-
-	uint8_t cmd[5] = {0x5A, 5, 0x22, 0, 0};
-	cmd[3] = amp_th;
-	return i2c_write_func(addr, cmd, 5);
+	bus->xfer              = NULL;
+	bus->i2c_write_it_func = i2c_write_it;
+	bus->i2c_read_it_func  = i2c_read_it;
+	bus->xfer_notify_func  = notify;
+	bus->xfer_wait_func    = wait;
 }
 
 /** 
-  * @描述   获取雷达AMP阈值函数
-  * @参数   addr：指定雷达的从机地址
-  * @参数   amp_th：AMP踢点阈值指针，数值为实际AMP阈值的10分之1
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   提交一次异步事务，启动指令发送后立即返回。cmd_len为0时直接读取应答。
+  *         同一总线同时只能有一个事务，事务结束前xfer不得释放。
+  * @参数   bus：总线句柄
+  * @参数   xfer：事务描述符
+  * @返回值 I2C_OK事务已启动，I2C_NOT_INIT未初始化，I2C_BUSY已有事务在进行，或启动函数返回的错误状态
   */
-uint8_t  MinipGetAmpThreshold(uint8_t addr, uint8_t *amp_th)
+uint8_t MinipBusXferSubmit(MinipBus *bus, MinipXferStruct *xfer)
 {
-	uint8_t cmd[5] = {0x5A, 5, 0x3F, 0x22, 0};
-	uint8_t ack[5];
-	if(I2C_OK == i2c_transcieve(addr, cmd, 5, ack, 5, 10))
+	uint8_t status;
+
+	if(!(bus->init_flag && bus->i2c_write_it_func))
 	{
-		*amp_th = ack[3];
-		return I2C_OK;
+		return I2C_NOT_INIT;
+	}
+	if(NULL != bus->xfer)
+	{
+		return I2C_BUSY;
+	}
+
+	xfer->status = I2C_OK;
+	bus->xfer    = xfer;
+	xfer->tick_start = MinipPerfNow(&bus->perf);
+	xfer->tick_write = xfer->tick_start;
+	xfer->tick_read  = xfer->tick_start;
+	if(0 == xfer->cmd_len)
+	{
+		xfer->state = MINIP_XFER_READ;
+		status = bus->i2c_read_it_func(xfer->addr, xfer->ack_buf, xfer->ack_len);
 	}
 	else
 	{
-		return I2C_ERROR;
+		xfer->state = MINIP_XFER_WRITE;
+		status = bus->i2c_write_it_func(xfer->addr, (uint8_t*)xfer->cmd_buf, xfer->cmd_len);
+	}
+	if(I2C_OK != status)
+	{
+		xfer_finish(bus, xfer, status);
+		return status;
 	}
+	return I2C_OK;
 }
 
 /** 
-  * @描述   设置距离限制函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @参数   min：雷达输出的最小距离值，单位cm
-  * @参数   max：雷达输出的最大距离值，单位cm
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   等待异步事务结束。事务需要等待雷达应答时，等待在此函数中完成，不占用中断。
+  *         超时后放弃事务并复位总线。
+  * @参数   bus：总线句柄
+  * @参数   xfer：已提交的事务描述符
+  * @参数   timeout：单次等待中断的超时时间，单位ms
+  * @返回值 事务结果，I2C_OK或详细错误状态，等待超时返回I2C_TIMEOUT
   */
-uint8_t  MinipSetDistLimit(uint8_t addr, uint16_t min, uint16_t max)
+uint8_t MinipBusXferWait(MinipBus *bus, MinipXferStruct *xfer, uint32_t timeout)
 {
-	if(!sInitFlag)
+	while(MINIP_XFER_DONE != xfer->state)
 	{
-		return I2C_ERROR;
+		if(MINIP_XFER_WAIT == xfer->state)
+		{
+			bus->delay_ms_func(xfer->wait_time);
+			xfer->tick_read = MinipPerfNow(&bus->perf);
+			xfer->state = MINIP_XFER_READ;
+			uint8_t status = bus->i2c_read_it_func(xfer->addr, xfer->ack_buf, xfer->ack_len);
+			if(I2C_OK != status)
+			{
+				xfer_finish(bus, xfer, status);
+			}
+		}
+		else if(I2C_OK != bus->xfer_wait_func(timeout))
+		{
+			xfer_finish(bus, xfer, I2C_TIMEOUT);
+			bus_reset(bus);
+		}
 	}
-
-	uint8_t cmd[9] = {0x5A, 9, 0x3A};
-	cmd[3] = min & 0xFF;
-	cmd[4] = (min >> 8) & 0xFF;
-	cmd[5] = max & 0xFF;
-	cmd[6] = (max >> 8) & 0xFF;
-	cmd[7] = 0;
-	return i2c_write_func(addr, cmd, 9);
+	return xfer->status;
 }
 
 /** 
-  * @描述   获取距离限制值函数
-  * @参数   addr：指定雷达的从机地址
-  * @参数   min：雷达输出的最小距离值指针，单位cm
-  * @参数   max：雷达输出的最大距离值指针，单位cm
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   异步事务的中断处理函数，在I2C发送完成、接收完成和错误中断中调用。
+  *         指令发送完成后，如果不需要等待，在中断中直接启动应答读取，使下一阶段无间隙地开始。
+  * @参数   bus：总线句柄
+  * @参数   status：刚结束的传输的结果，I2C_OK或详细错误状态
+  * @返回值 无
   */
-uint8_t  MinipGetDistLimit(uint8_t addr, uint16_t *min, uint16_t *max)
+void MinipBusXferCpltHandler(MinipBus *bus, uint8_t status)
 {
-	uint8_t cmd[5] = {0x5A, 5, 0x3F, 0x3A, 0};
-	uint8_t ack[9];
-	if(I2C_OK == i2c_transcieve(addr, cmd, 5, ack, 9, 10))
+	MinipXferStruct *xfer = bus->xfer;
+	if(NULL == xfer)
 	{
-		*min = (uint16_t)ack[3] + (((uint16_t)ack[4]) << 8);
-		*max = (uint16_t)ack[5] + (((uint16_t)ack[6]) << 8);
-		return I2C_OK;
+		return;
 	}
-	else
+
+	if(MINIP_XFER_WRITE == xfer->state)
+	{
+		xfer->tick_write = MinipPerfNow(&bus->perf);
+		xfer->tick_read  = xfer->tick_write;
+	}
+
+	if((I2C_OK == status) && (MINIP_XFER_WRITE == xfer->state) && (xfer->ack_len > 0))
 	{
-		return I2C_ERROR;
+		if(xfer->wait_time > 0)
+		{
+			xfer->state = MINIP_XFER_WAIT;
+			bus->xfer_notify_func();
+			return;
+		}
+
+		xfer->state = MINIP_XFER_READ;
+		status = bus->i2c_read_it_func(xfer->addr, xfer->ack_buf, xfer->ack_len);
+		if(I2C_OK == status)
+		{
+			return;
+		}
 	}
 
+	xfer_finish(bus, xfer, status);
+	bus->xfer_notify_func();
 }
 
 /** 
-  * @描述   Minip时间戳同步函数
-  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
-  * @参数   std：指定的当前时间，单位ms
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @描述   查找雷达的健康记录
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @返回值 健康记录的序号，找不到时返回MINIP_MAX_DEV
   */
-uint8_t  MinipTimestampSync(uint8_t addr, uint32_t std)
+static uint8_t dev_find(MinipBus *bus, uint8_t addr)
 {
-	if(!sInitFlag)
+	for(uint8_t k = 0; k < bus->dev_num; k++)
 	{
-		return I2C_ERROR;
-	}
+		if(addr == bus->dev[k].addr)
+		{
+			return k;
+		}
+	}
+	return MINIP_MAX_DEV;
+}
+
+/** 
+  * @描述   为新加入设备集合的雷达建立健康记录，初始状态为正常。记录已满时不建立。
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @返回值 无
+  */
+static void dev_add(MinipBus *bus, uint8_t addr)
+{
+	if((bus->dev_num >= MINIP_MAX_DEV) || (MINIP_MAX_DEV != dev_find(bus, addr)))
+	{
+		return;
+	}
+	memset(&bus->dev[bus->dev_num], 0, sizeof(MinipDevStruct));
+	bus->dev[bus->dev_num].addr = addr;
+	bus->dev_num++;
+}
+
+/** 
+  * @描述   删除移出设备集合的雷达的健康记录，其余记录保持原有顺序
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @返回值 无
+  */
+static void dev_remove(MinipBus *bus, uint8_t addr)
+{
+	uint8_t k = dev_find(bus, addr);
+	if(MINIP_MAX_DEV == k)
+	{
+		return;
+	}
+	bus->dev_num--;
+	memmove(&bus->dev[k], &bus->dev[k + 1], (bus->dev_num - k) * sizeof(MinipDevStruct));
+}
+
+/** 
+  * @描述   更新设备集合中一个地址的状态，状态发生变化时发布设备变化事件
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   present：1设备存在，0设备不存在
+  * @返回值 状态发生变化返回1，否则返回0
+  */
+static uint8_t dev_set_update(MinipBus *bus, uint8_t addr, uint8_t present)
+{
+	if(present == MinipAddrSetContains(&bus->dev_set, addr))
+	{
+		return 0;
+	}
+
+	if(present)
+	{
+		MinipAddrSetInsert(&bus->dev_set, addr);
+		dev_add(bus, addr);
+	}
+	else
+	{
+		MinipAddrSetRemove(&bus->dev_set, addr);
+		dev_remove(bus, addr);
+	}
+	if(NULL != bus->dev_event_func)
+	{
+		bus->dev_event_func(addr, present ? MINIP_DEV_ADDED : MINIP_DEV_REMOVED);
+	}
+	return 1;
+}
+
+/** 
+  * @描述   获取指令发送后到第一次读取应答的等待时间。固定等待时为MINIP_ACK_WAIT_MS；
+  *         自适应等待时为该雷达观测到的最短应答时间，尚未观测到时为MINIP_ACK_POLL_MS。
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @返回值 等待时间，单位ms
+  */
+static uint8_t ack_wait_get(MinipBus *bus, uint8_t addr)
+{
+	uint8_t k;
+
+	if(!bus->adaptive_wait)
+	{
+		return MINIP_ACK_WAIT_MS;
+	}
+	k = dev_find(bus, addr);
+	if((MINIP_MAX_DEV == k) || (0 == bus->dev[k].ack_wait))
+	{
+		return MINIP_ACK_POLL_MS;
+	}
+	return bus->dev[k].ack_wait;
+}
+
+/** 
+  * @描述   读取配置应答。自适应等待时，应答未就绪(帧校验失败)则每隔MINIP_ACK_POLL_MS再读一次，
+  *         直到成功或累计等待达到MINIP_ACK_WAIT_MS，成功时记录该雷达的最短应答时间。
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   ack：应答接收地址，已经读过一次
+  * @参数   ack_len：应答长度
+  * @参数   id：期望的应答ID
+  * @参数   waited：指令发送后已经等待的时间，单位ms
+  * @参数   ret：第一次读取和校验的结果
+  * @返回值 I2C_OK或详细错误状态
+  */
+static uint8_t ack_poll(MinipBus *bus, uint8_t addr, uint8_t *ack, uint8_t ack_len, uint8_t id, uint8_t waited, uint8_t ret)
+{
+	uint8_t k;
+
+	while((I2C_FRAME_ERROR == ret) && bus->adaptive_wait && (waited < MINIP_ACK_WAIT_MS))
+	{
+		bus->delay_ms_func(MINIP_ACK_POLL_MS);
+		waited += MINIP_ACK_POLL_MS;
+		ret = i2c_read(bus, addr, ack, ack_len);
+		if(I2C_OK == ret)
+		{
+			ret = check_ack_frame(ack, ack_len, id);
+		}
+	}
+
+	if(I2C_FRAME_ERROR == ret)
+	{
+		stat_record(bus, addr, ret);
+	}
+	if((I2C_OK == ret) && bus->adaptive_wait)
+	{
+		k = dev_find(bus, addr);
+		if((MINIP_MAX_DEV != k) && ((0 == bus->dev[k].ack_wait) || (waited < bus->dev[k].ack_wait)))
+		{
+			bus->dev[k].ack_wait = waited;
+		}
+	}
+	return ret;
+}
+
+/** 
+  * @描述   指令已经发送并等待后，读取配置应答，未就绪时继续轮询，见ack_poll
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   ack：应答接收地址
+  * @参数   ack_len：应答长度
+  * @参数   id：期望的应答ID
+  * @参数   waited：指令发送后已经等待的时间，单位ms
+  * @返回值 I2C_OK或详细错误状态
+  */
+static uint8_t ack_read(MinipBus *bus, uint8_t addr, uint8_t *ack, uint8_t ack_len, uint8_t id, uint8_t waited)
+{
+	uint8_t ret = i2c_read(bus, addr, ack, ack_len);
+	if(I2C_OK == ret)
+	{
+		ret = check_ack_frame(ack, ack_len, id);
+	}
+	return ack_poll(bus, addr, ack, ack_len, id, waited, ret);
+}
+
+/** 
+  * @描述   发送指令并读取、校验配置应答帧。应答ID由指令推出：读取配置指令的应答ID为被读取的配置项，其余为指令ID。
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   cmd_buf：指令地址
+  * @参数   cmd_len：指令长度
+  * @参数   ack_buf：应答接收地址
+  * @参数   ack_len：应答长度
+  * @返回值 I2C_OK或详细错误状态
+  */
+static uint8_t i2c_query(MinipBus *bus, uint8_t addr, const uint8_t *cmd_buf, uint8_t cmd_len, uint8_t *ack_buf, uint8_t ack_len)
+{
+	uint8_t id   = (MINIP_ID_GET == cmd_buf[2]) ? cmd_buf[3] : cmd_buf[2];
+	uint8_t wait = ack_wait_get(bus, addr);
+	uint8_t ret  = i2c_transcieve(bus, addr, cmd_buf, cmd_len, ack_buf, ack_len, wait);
+	if(I2C_OK == ret)
+	{
+		ret = check_ack_frame(ack_buf, ack_len, id);
+		ret = ack_poll(bus, addr, ack_buf, ack_len, id, wait, ret);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   查找雷达的配置缓存
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @返回值 配置缓存，雷达没有健康记录时返回NULL
+  */
+static MinipCacheStruct *cache_find(MinipBus *bus, uint8_t addr)
+{
+	uint8_t k = dev_find(bus, addr);
+	return (MINIP_MAX_DEV == k) ? NULL : &bus->dev[k].cache;
+}
+
+/** 
+  * @描述   根据一次设置或读取的结果更新配置缓存。成功时复制mask指定的配置项并置为有效，
+  *         失败时雷达的实际配置未知，将这些项置为无效。
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址，为0时表示广播，更新所有雷达的缓存
+  * @参数   mask：配置项，见MINIP_CACHE_xxx
+  * @参数   val：配置值，只使用mask指定的项
+  * @参数   status：设置或读取的结果
+  * @返回值 无
+  */
+static void cache_store(MinipBus *bus, uint8_t addr, uint8_t mask, const MinipCacheStruct *val, uint8_t status)
+{
+	for(uint8_t k = 0; k < bus->dev_num; k++)
+	{
+		MinipCacheStruct *cache = &bus->dev[k].cache;
+		if((0 != addr) && (addr != bus->dev[k].addr))
+		{
+			continue;
+		}
+		if(I2C_OK != status)
+		{
+			cache->valid &= ~mask;
+			continue;
+		}
+		if(mask & MINIP_CACHE_RATE)
+		{
+			cache->rate = val->rate;
+		}
+		if(mask & MINIP_CACHE_EN)
+		{
+			cache->en = val->en;
+		}
+		if(mask & MINIP_CACHE_AMP_TH)
+		{
+			cache->amp_th = val->amp_th;
+		}
+		if(mask & MINIP_CACHE_DIST_LIMIT)
+		{
+			cache->dist_min = val->dist_min;
+			cache->dist_max = val->dist_max;
+		}
+		if(mask & MINIP_CACHE_VERSION)
+		{
+			cache->version = val->version;
+		}
+		cache->valid |= mask;
+	}
+}
+
+/** 
+  * @描述   获取配置指令的应答长度。设置类指令的应答与指令相同，复位、恢复出厂设置和保存设置的应答带有执行结果，
+  *         其余指令没有应答。
+  * @参数   cmd：指令帧
+  * @参数   cmd_len：指令长度
+  * @返回值 应答长度，0表示没有应答
+  */
+static uint8_t cmd_ack_len(const uint8_t *cmd, uint8_t cmd_len)
+{
+	switch(cmd[2])
+	{
+		case MINIP_ID_SAMPLE_RATE:
+		case MINIP_ID_OUTPUT_EN:
+		case MINIP_ID_SLAVE_ADDR:
+		case MINIP_ID_AMP_TH:
+		case MINIP_ID_DIST_LIMIT:
+			return cmd_len;
+		case MINIP_ID_SOFT_RESET:
+		case MINIP_ID_RESTORE:
+		case MINIP_ID_SAVE:
+			return 5;
+		default:
+			return 0;
+	}
+}
+
+/** 
+  * @描述   判断一条指令发送后是否需要读取并校验应答
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   cmd：指令帧
+  * @参数   cmd_len：指令长度
+  * @返回值 1需要校验，0不需要
+  */
+static uint8_t cmd_need_verify(MinipBus *bus, uint8_t addr, const uint8_t *cmd, uint8_t cmd_len)
+{
+	return (bus->verify_flag && (0 != addr) && (cmd_ack_len(cmd, cmd_len) > 0)) ? 1 : 0;
+}
+
+/** 
+  * @描述   读取并校验配置指令的应答。设置类指令的应答须与指令完全相同，其余指令的应答中执行结果须为0。
+  *         修改从机地址后雷达可能已改用新地址，原地址无应答时从新地址读取。
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   cmd：已发送的指令帧
+  * @参数   cmd_len：指令长度
+  * @参数   waited：指令发送后已经等待的时间，单位ms
+  * @返回值 I2C_OK、I2C_FRAME_ERROR、I2C_VERIFY_ERROR或详细错误状态
+  */
+static uint8_t cmd_read_ack(MinipBus *bus, uint8_t addr, const uint8_t *cmd, uint8_t cmd_len, uint8_t waited)
+{
+	uint8_t ack[9];
+	uint8_t ack_len = cmd_ack_len(cmd, cmd_len);
+	uint8_t ret = i2c_read(bus, addr, ack, ack_len);
+
+	if((I2C_ADDR_NACK == ret) && (MINIP_ID_SLAVE_ADDR == cmd[2]))
+	{
+		addr = cmd[3];
+		ret  = i2c_read(bus, addr, ack, ack_len);
+	}
+	if(I2C_OK == ret)
+	{
+		ret = check_ack_frame(ack, ack_len, cmd[2]);
+	}
+	ret = ack_poll(bus, addr, ack, ack_len, cmd[2], waited, ret);
+	if(I2C_OK != ret)
+	{
+		return ret;
+	}
+
+	if(ack_len == cmd_len)
+	{
+		ret = (0 == memcmp(ack, cmd, cmd_len)) ? I2C_OK : I2C_VERIFY_ERROR;
+	}
+	else
+	{
+		ret = (0 == ack[3]) ? I2C_OK : I2C_VERIFY_ERROR;
+	}
+	if(I2C_OK != ret)
+	{
+		stat_record(bus, addr, ret);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   发送一条配置指令，开启校验时等待后读取并校验应答
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址，为0时只发送不校验
+  * @参数   cmd：指令帧
+  * @参数   cmd_len：指令长度
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+static uint8_t cmd_write(MinipBus *bus, uint8_t addr, const uint8_t *cmd, uint8_t cmd_len)
+{
+	uint8_t ret = i2c_write(bus, addr, cmd, cmd_len);
+	if((I2C_OK == ret) && cmd_need_verify(bus, addr, cmd, cmd_len))
+	{
+		uint8_t wait = ack_wait_get(bus, addr);
+		bus->delay_ms_func(wait);
+		ret = cmd_read_ack(bus, addr, cmd, cmd_len, wait);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   向多台雷达发送同一条配置指令。先向所有雷达发送指令，开启校验时只等待一次，再依次读回并校验应答，
+  *         雷达数量增加时等待时间不随之增加。
+  * @参数   bus：总线句柄
+  * @参数   addr_list：雷达从机地址列表
+  * @参数   n：雷达数量，不超过MINIP_LIST_MAX，超出的雷达不处理
+  * @参数   sel：按序号选择发送的雷达，每台一位，为NULL时发送给全部雷达
+  * @参数   cmd：指令帧
+  * @参数   cmd_len：指令长度
+  * @参数   ok：按序号输出成功的雷达，每台一位，为NULL时不输出
+  * @参数   status：每台雷达的结果，第k台写入status[k * status_step]，未选择的雷达不写入；为NULL时不输出
+  * @参数   status_step：相邻两台雷达的结果之间的字节数
+  * @返回值 全部成功返回I2C_OK，否则返回最后一个失败的状态
+  */
+static uint8_t cmd_write_many(MinipBus *bus, uint8_t *addr_list, uint8_t n, const uint32_t *sel, const uint8_t *cmd, uint8_t cmd_len,
+                              uint32_t *ok, uint8_t *status, uint32_t status_step)
+{
+	uint32_t sent[MINIP_LIST_MASK_NUM] = {0};  // 按序号记录需要读取应答的雷达
+	uint8_t  wait = 0;       // 所有需要读取应答的雷达中最长的等待时间
+	uint8_t  ret = I2C_OK;
+	uint8_t  st;
+
+	if(n > MINIP_LIST_MAX)
+	{
+		n = MINIP_LIST_MAX;  // 按序号记录的标志只有MINIP_LIST_MAX位
+	}
+
+	// 第一阶段：向所有选中的雷达发送指令
+	for(uint8_t k = 0; k < n; k++)
+	{
+		if((NULL != sel) && (0 == (sel[k >> 5] & (1UL << (k & 31)))))
+		{
+			continue;
+		}
+		st = i2c_write(bus, addr_list[k], cmd, cmd_len);
+		if((I2C_OK == st) && cmd_need_verify(bus, addr_list[k], cmd, cmd_len))
+		{
+			uint8_t t = ack_wait_get(bus, addr_list[k]);
+			sent[k >> 5] |= 1UL << (k & 31);
+			wait = (t > wait) ? t : wait;
+		}
+		else if((I2C_OK == st) && (NULL != ok))
+		{
+			ok[k >> 5] |= 1UL << (k & 31);
+		}
+		if(I2C_OK != st)
+		{
+			ret = st;
+		}
+		if(NULL != status)
+		{
+			status[k * status_step] = st;
+		}
+	}
+	if(0 == wait)
+	{
+		return ret;
+	}
+
+	// 第二阶段：等待一次，再依次读回并校验应答
+	bus->delay_ms_func(wait);
+	for(uint8_t k = 0; k < n; k++)
+	{
+		if(0 == (sent[k >> 5] & (1UL << (k & 31))))
+		{
+			continue;
+		}
+		st = cmd_read_ack(bus, addr_list[k], cmd, cmd_len, wait);
+		if((I2C_OK == st) && (NULL != ok))
+		{
+			ok[k >> 5] |= 1UL << (k & 31);
+		}
+		if(I2C_OK != st)
+		{
+			ret = st;
+		}
+		if(NULL != status)
+		{
+			status[k * status_step] = st;
+		}
+	}
+	return ret;
+}
+
+/** 
+  * @描述   生成一个配置项的设置指令
+  * @参数   field：配置项，见MinipConfigFieldEnum
+  * @参数   cfg：配置值
+  * @参数   cmd：指令帧，长度不小于9
+  * @返回值 指令长度
+  */
+static uint8_t config_build(uint8_t field, const MinipConfig *cfg, uint8_t *cmd)
+{
+	switch(field)
+	{
+		case MINIP_CFG_RATE:
+			memcpy(cmd, minip_cmd_set_sample_rate, sizeof(minip_cmd_set_sample_rate));
+			MINIP_CMD_PATCH_LEN(cmd, sizeof(minip_cmd_set_sample_rate), 3, cfg->rate & 0xFF);
+			MINIP_CMD_PATCH_LEN(cmd, sizeof(minip_cmd_set_sample_rate), 4, (cfg->rate >> 8) & 0xFF);
+			return sizeof(minip_cmd_set_sample_rate);
+		case MINIP_CFG_EN:
+			memcpy(cmd, cfg->en ? minip_cmd_enable : minip_cmd_disable, sizeof(minip_cmd_enable));
+			return sizeof(minip_cmd_enable);
+		case MINIP_CFG_AMP_TH:
+			memcpy(cmd, minip_cmd_set_amp_th, sizeof(minip_cmd_set_amp_th));
+			MINIP_CMD_PATCH_LEN(cmd, sizeof(minip_cmd_set_amp_th), 3, cfg->amp_th);
+			return sizeof(minip_cmd_set_amp_th);
+		case MINIP_CFG_DIST_LIMIT:
+			memcpy(cmd, minip_cmd_set_dist_limit, sizeof(minip_cmd_set_dist_limit));
+			MINIP_CMD_PATCH_LEN(cmd, sizeof(minip_cmd_set_dist_limit), 3, cfg->dist_min & 0xFF);
+			MINIP_CMD_PATCH_LEN(cmd, sizeof(minip_cmd_set_dist_limit), 4, (cfg->dist_min >> 8) & 0xFF);
+			MINIP_CMD_PATCH_LEN(cmd, sizeof(minip_cmd_set_dist_limit), 5, cfg->dist_max & 0xFF);
+			MINIP_CMD_PATCH_LEN(cmd, sizeof(minip_cmd_set_dist_limit), 6, (cfg->dist_max >> 8) & 0xFF);
+			return sizeof(minip_cmd_set_dist_limit);
+		default:
+			return 0;
+	}
+}
+
+/** 
+  * @描述   根据设置结果更新一个配置项的缓存
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址，为0时更新所有雷达
+  * @参数   field：配置项，见MinipConfigFieldEnum
+  * @参数   cfg：设置的配置值
+  * @参数   status：设置结果
+  * @返回值 无
+  */
+static void config_cache_store(MinipBus *bus, uint8_t addr, uint8_t field, const MinipConfig *cfg, uint8_t status)
+{
+	MinipCacheStruct val;
+
+	val.rate     = cfg->rate;
+	val.en       = cfg->en;
+	val.amp_th   = cfg->amp_th;
+	val.dist_min = cfg->dist_min;
+	val.dist_max = cfg->dist_max;
+	cache_store(bus, addr, 1 << field, &val, status);
+}
+
+/** 
+  * @描述   设置一台雷达的一个配置项，成功后配置缓存随之更新
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址，为0时对总线上的所有雷达有效
+  * @参数   field：配置项，见MinipConfigFieldEnum
+  * @参数   cfg：配置值
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+static uint8_t config_write(MinipBus *bus, uint8_t addr, uint8_t field, const MinipConfig *cfg)
+{
+	uint8_t cmd[9];
+	uint8_t len = config_build(field, cfg, cmd);
+	uint8_t ret = cmd_write(bus, addr, cmd, len);
+	config_cache_store(bus, addr, field, cfg, ret);
+	return ret;
+}
+
+/** 
+  * @描述   设置多台雷达的同一个配置项，应答的等待时间只付出一次，见cmd_write_many
+  * @参数   bus：总线句柄
+  * @参数   addr_list：雷达从机地址列表
+  * @参数   n：雷达数量，不超过MINIP_LIST_MAX，超出的雷达不处理
+  * @参数   sel：按序号选择设置的雷达，为NULL时设置全部雷达
+  * @参数   field：配置项，见MinipConfigFieldEnum
+  * @参数   cfg：配置值
+  * @参数   status：每台雷达的结果，见cmd_write_many，为NULL时不输出
+  * @参数   status_step：相邻两台雷达的结果之间的字节数
+  * @返回值 全部成功返回I2C_OK，否则返回最后一个失败的状态
+  */
+static uint8_t config_write_many(MinipBus *bus, uint8_t *addr_list, uint8_t n, const uint32_t *sel, uint8_t field, const MinipConfig *cfg, uint8_t *status, uint32_t status_step)
+{
+	uint32_t ok[MINIP_LIST_MASK_NUM] = {0};
+	uint8_t  cmd[9];
+	uint8_t  len = config_build(field, cfg, cmd);
+	uint8_t  ret;
+
+	if(n > MINIP_LIST_MAX)
+	{
+		n = MINIP_LIST_MAX;  // 按序号记录的标志只有MINIP_LIST_MAX位
+	}
+	ret = cmd_write_many(bus, addr_list, n, sel, cmd, len, ok, status, status_step);
+
+	for(uint8_t k = 0; k < n; k++)
+	{
+		if((NULL != sel) && (0 == (sel[k >> 5] & (1UL << (k & 31)))))
+		{
+			continue;
+		}
+		config_cache_store(bus, addr_list[k], field, cfg, (ok[k >> 5] & (1UL << (k & 31))) ? I2C_OK : I2C_ERROR);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   注册总线扫描使用的函数。注册后扫描只发送从机地址，雷达不会收到无效的指令字节，
+  *         并且只在总线确实卡死时复位总线。须在MinipBusInit之后调用，参数可以为NULL。
+  * @参数   bus：总线句柄
+  * @参数   probe：地址探测函数
+  * @参数   stuck：总线卡死检测函数
+  * @返回值 无
+  */
+void MinipBusScanInit(MinipBus *bus, I2cProbeFuncPtr probe, I2cBusStuckFuncPtr stuck)
+{
+	bus->i2c_probe_func = probe;
+	bus->i2c_stuck_func = stuck;
+}
+
+/** 
+  * @描述   I2C总线设备查询函数，探测全部地址[1, 127]
+  * @参数   bus：总线句柄
+  * @参数   list：设备列表，由调用者提供，扫描结果按地址从小到大填入；为NULL时只更新总线的设备集合
+  * @返回值 总线上的设备数量
+  */
+uint8_t MinipBusI2cScanBus(MinipBus *bus, MinipDevListStruct *list)
+{
+	MinipAddrSetStruct hint;
+
+	MinipAddrSetClear(&hint);
+	MinipAddrSetInsertRange(&hint, 1, 127);
+	return MinipBusI2cScanHint(bus, &hint, list);
+}
+
+/** 
+  * @描述   只探测提示集合中的地址，更新这些地址在设备集合中的状态，其余地址保持不变。
+  *         可以用于扫描指定的地址范围，或者只确认已知设备是否仍在总线上。
+  * @参数   bus：总线句柄
+  * @参数   hint：需要探测的地址集合，可以直接传入总线的设备集合
+  * @参数   list：设备列表，由调用者提供，扫描后总线上的全部设备按地址从小到大填入；为NULL时只更新总线的设备集合
+  * @返回值 总线上的设备数量
+  */
+uint8_t MinipBusI2cScanHint(MinipBus *bus, const MinipAddrSetStruct *hint, MinipDevListStruct *list)
+{
+	MinipAddrSetStruct probe_set = *hint;   // 复制一份，hint可能就是设备集合本身
+	uint8_t num;
+
+	MINIP_TRACE_SCAN_BEGIN(addr_set_count(&probe_set));
+	if(bus->init_flag)
+	{
+		scan_recover(bus);
+		for(uint8_t n = 1; n <= 127; n++)
+		{
+			// 跳过不需要探测的地址，排除集合中的地址不探测并移出设备集合
+			if(!MinipAddrSetContains(&probe_set, n))
+			{
+				continue;
+			}
+			if(MinipAddrSetContains(&bus->ex_set, n))
+			{
+				(void)dev_set_update(bus, n, 0);
+				continue;
+			}
+
+			if(I2C_OK == probe_addr(bus, n))
+			{
+				(void)dev_set_update(bus, n, 1);
+			}
+			else
+			{
+				(void)dev_set_update(bus, n, 0);
+				scan_recover(bus);
+			}
+		}
+	}
+	else
+	{
+		MinipAddrSetClear(&bus->dev_set);
+	}
+
+	if(NULL != list)
+	{
+		num = MinipAddrSetToList(&bus->dev_set, list);
+	}
+	else
+	{
+		num = addr_set_count(&bus->dev_set);
+	}
+	MINIP_TRACE_SCAN_DONE(num);
+	return num;
+}
+
+/** 
+  * @描述   配置增量设备发现。开启后，每个采集周期调用一次MinipBusHotplugStep，
+  *         利用总线空闲时间轮流探测少量未使用的地址，无需全地址扫描即可发现新接入的雷达。
+  * @参数   bus：总线句柄
+  * @参数   step：每次最多探测的地址数，为0时关闭增量发现
+  * @参数   event：设备变化通知函数，全地址扫描和提示扫描发现的变化同样通过此函数通知，可以为NULL
+  * @返回值 无
+  */
+void MinipBusHotplugInit(MinipBus *bus, uint8_t step, DevEventFuncPtr event)
+{
+	bus->hotplug_cursor = 1;
+	bus->hotplug_step   = step;
+	bus->dev_event_func = event;
+}
+
+/** 
+  * @描述   执行一步增量设备发现，从上次停止的位置开始，探测不超过hotplug_step个不在设备集合和排除集合中的地址。
+  *         已知设备的消失由读取失败后的提示扫描发现，此函数只探测未使用的地址。
+  * @参数   bus：总线句柄
+  * @参数   list：设备列表，由调用者提供，设备集合发生变化时重新填入；为NULL时只更新总线的设备集合
+  * @返回值 本次发现的新设备数量
+  */
+uint8_t MinipBusHotplugStep(MinipBus *bus, MinipDevListStruct *list)
+{
+	uint8_t probed  = 0;
+	uint8_t changed = 0;
+
+	if(!bus->init_flag || (0 == bus->hotplug_step))
+	{
+		return 0;
+	}
+
+	for(uint8_t k = 0; (k < 127) && (probed < bus->hotplug_step); k++)
+	{
+		uint8_t n = bus->hotplug_cursor;
+		bus->hotplug_cursor = (n >= 127) ? 1 : (n + 1);
+		if(MinipAddrSetContains(&bus->dev_set, n) || MinipAddrSetContains(&bus->ex_set, n))
+		{
+			continue;
+		}
+
+		probed++;
+		if(I2C_OK == probe_addr(bus, n))
+		{
+			changed += dev_set_update(bus, n, 1);
+		}
+		else
+		{
+			scan_recover(bus);
+		}
+	}
+
+	if((changed > 0) && (NULL != list))
+	{
+		(void)MinipAddrSetToList(&bus->dev_set, list);
+	}
+	return changed;
+}
+
+/** 
+  * @描述   根据健康记录判断一台雷达本周期是否轮询。重试中的雷达在退避间隔结束后轮询；
+  *         隔离中的雷达在隔离期结束后单独探测一次地址，有应答则恢复为重试状态并轮询，无应答则移出设备集合。
+  * @参数   bus：总线句柄
+  * @参数   k：健康记录的序号
+  * @返回值 1本周期轮询，0跳过，2已移出设备集合，后面的记录前移一位
+  */
+static uint8_t health_due(MinipBus *bus, uint8_t k)
+{
+	MinipDevStruct *dev = &bus->dev[k];
+
+	if(dev->wait > 0)
+	{
+		dev->wait--;
+		return 0;
+	}
+	if(MINIP_HEALTH_QUARANTINED == dev->health)
+	{
+		if(I2C_OK != probe_addr(bus, dev->addr))
+		{
+			scan_recover(bus);
+			(void)dev_set_update(bus, dev->addr, 0);
+			return 2;
+		}
+		dev->health  = MINIP_HEALTH_RETRYING;
+		dev->backoff = 1;
+	}
+	return 1;
+}
+
+/** 
+  * @描述   选出本周期需要轮询的雷达，每个采集周期调用一次。正常和可疑的雷达每个周期都被选中；
+  *         重试中的雷达在退避间隔结束后被选中；隔离中的雷达在隔离期结束后单独探测一次地址，
+  *         有应答则恢复为重试状态并参与本周期轮询，无应答则移出设备集合，之后由增量发现重新发现。
+  *         一台雷达的故障只影响它自己，其余雷达的轮询节奏不变。
+  *         设备记录已满、没有记录的雷达不跟踪健康状态，只要在设备集合中就每个周期都被选中。
+  * @参数   bus：总线句柄
+  * @参数   poll：本周期需要轮询的地址列表，由调用者提供，按地址升序
+  * @返回值 本周期需要轮询的雷达数量
+  */
+uint8_t MinipBusHealthSelect(MinipBus *bus, MinipDevListStruct *poll)
+{
+	poll->num = 0;
+	if(!bus->init_flag)
+	{
+		return 0;
+	}
+
+	(void)MinipAddrSetToList(&bus->dev_set, poll);
+	return MinipBusHealthFilter(bus, poll);
+}
+
+/** 
+  * @描述   从调用者选出的雷达中去掉本次不应轮询的雷达，用于各雷达读取周期不同的场合，例如由调度器决定读取哪些雷达。
+  *         退避和隔离间隔以该雷达自己被选中的次数计算，判断方法与MinipBusHealthSelect相同；不在设备集合中的雷达也被去掉。
+  * @参数   bus：总线句柄
+  * @参数   poll：候选的地址列表，原地保留需要轮询的雷达，顺序不变
+  * @返回值 需要轮询的雷达数量
+  */
+uint8_t MinipBusHealthFilter(MinipBus *bus, MinipDevListStruct *poll)
+{
+	uint8_t n = 0;
+
+	for(uint8_t j = 0; j < poll->num; j++)
+	{
+		uint8_t addr = poll->addr_list[j];
+		uint8_t k = dev_find(bus, addr);
+
+		if(!MinipAddrSetContains(&bus->dev_set, addr))
+		{
+			continue;
+		}
+		if((MINIP_MAX_DEV != k) && (1 != health_due(bus, k)))
+		{
+			continue;
+		}
+		poll->addr_list[n++] = addr;
+	}
+	poll->num = n;
+	return n;
+}
+
+/** 
+  * @描述   报告一台雷达本周期的轮询结果，更新其健康状态
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @参数   status：轮询结果，I2C_OK为成功，其余均视为失败
+  * @返回值 无
+  */
+void MinipBusHealthReport(MinipBus *bus, uint8_t addr, uint8_t status)
+{
+	uint8_t k = dev_find(bus, addr);
+	if(MINIP_MAX_DEV == k)
+	{
+		return;
+	}
+
+	MinipDevStruct *dev = &bus->dev[k];
+	if(I2C_OK == status)
+	{
+		// 连续失败期间雷达可能被重新上电，恢复后的配置不一定与缓存相同
+		if(dev->health >= MINIP_HEALTH_RETRYING)
+		{
+			dev->cache.valid = 0;
+		}
+		dev->health   = MINIP_HEALTH_OK;
+		dev->fail_cnt = 0;
+		dev->backoff  = 0;
+		dev->wait     = 0;
+		return;
+	}
+
+	if(dev->fail_cnt < 0xFF)
+	{
+		dev->fail_cnt++;
+	}
+	switch(dev->health)
+	{
+		case MINIP_HEALTH_OK:
+			dev->health = MINIP_HEALTH_SUSPECT;
+			break;
+		case MINIP_HEALTH_SUSPECT:
+			dev->health  = MINIP_HEALTH_RETRYING;
+			dev->backoff = 1;
+			dev->wait    = dev->backoff;
+			break;
+		case MINIP_HEALTH_RETRYING:
+			if(dev->fail_cnt >= MINIP_HEALTH_RETRY_MAX)
+			{
+				dev->health = MINIP_HEALTH_QUARANTINED;
+				dev->wait   = MINIP_HEALTH_BACKOFF_MAX;
+			}
+			else
+			{
+				dev->backoff = (dev->backoff * 2 > MINIP_HEALTH_BACKOFF_MAX) ? MINIP_HEALTH_BACKOFF_MAX : (dev->backoff * 2);
+				dev->wait    = dev->backoff;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/** 
+  * @描述   查询雷达的健康状态
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址
+  * @返回值 健康状态，见MinipHealthEnum，没有健康记录的地址返回MINIP_HEALTH_GONE
+  */
+uint8_t MinipBusHealthGet(MinipBus *bus, uint8_t addr)
+{
+	uint8_t k = dev_find(bus, addr);
+	if(MINIP_MAX_DEV == k)
+	{
+		return MINIP_HEALTH_GONE;
+	}
+	return bus->dev[k].health;
+}
+
+/** 
+  * @描述   读取总线上所有事务按结果分类的累计次数
+  * @参数   bus：总线句柄
+  * @参数   status_cnt：累计次数数组，长度不小于MINIP_STATUS_NUM，下标为状态值
+  * @返回值 无
+  */
+void MinipBusGetBusStat(MinipBus *bus, uint32_t *status_cnt)
+{
+	memcpy(status_cnt, bus->status_cnt, sizeof(bus->status_cnt));
+}
+
+/** 
+  * @描述   读取指定从机地址按结果分类的累计次数
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址，0为广播事务
+  * @参数   status_cnt：累计次数数组，长度不小于MINIP_STATUS_NUM，下标为状态值
+  * @返回值 I2C_OK，该地址没有统计记录时返回I2C_ERROR且不修改status_cnt
+  */
+uint8_t MinipBusGetAddrStat(MinipBus *bus, uint8_t addr, uint32_t *status_cnt)
+{
+	for(uint8_t k = 0; k < bus->stat_num; k++)
+	{
+		if(addr == bus->stat[k].addr)
+		{
+			memcpy(status_cnt, bus->stat[k].status_cnt, sizeof(bus->stat[k].status_cnt));
+			return I2C_OK;
+		}
+	}
+	return I2C_ERROR;
+}
+
+/** 
+  * @描述   清空总线和所有从机地址的累计次数
+  * @参数   bus：总线句柄
+  * @返回值 无
+  */
+void MinipBusClearStat(MinipBus *bus)
+{
+	bus->xfer_cnt = 0;
+	memset(bus->status_cnt, 0, sizeof(bus->status_cnt));
+	memset(bus->stat, 0, sizeof(bus->stat));
+	bus->stat_num = 0;
+	MinipPerfClear(&bus->perf);
+}
+
+/** 
+  * @描述   注册事务计时函数，开启延时直方图和总线占用率统计，须在MinipBusInit之后调用
+  * @参数   bus：总线句柄
+  * @参数   tick：计时函数，返回自由运行的32位计数值，为NULL时关闭统计
+  * @参数   tick_per_us：每微秒的计数值
+  * @返回值 无
+  */
+void MinipBusTimingInit(MinipBus *bus, TickFuncPtr tick, uint32_t tick_per_us)
+{
+	MinipPerfInit(&bus->perf, tick, tick_per_us);
+}
+
+/** 
+  * @描述   开启或关闭配置指令的校验。开启后，设置、复位、恢复出厂设置和保存设置指令发送后，
+  *         读取雷达的应答并校验，与指令不符或雷达报告执行失败时返回I2C_VERIFY_ERROR。
+  *         发往广播地址0的指令无法读取应答，不校验。
+  * @参数   bus：总线句柄
+  * @参数   enable：1开启，0关闭
+  * @返回值 无
+  */
+void MinipBusVerifyInit(MinipBus *bus, uint8_t enable)
+{
+	bus->verify_flag = enable ? 1 : 0;
+}
+
+/** 
+  * @描述   开启或关闭配置应答的自适应等待。关闭时每次读取应答前固定等待MINIP_ACK_WAIT_MS；
+  *         开启后先等待该雷达观测到的最短应答时间，应答未就绪时每隔MINIP_ACK_POLL_MS重读，
+  *         最长仍为MINIP_ACK_WAIT_MS，读取配置的延时接近雷达实际的应答时间。
+  * @参数   bus：总线句柄
+  * @参数   enable：1开启，0关闭
+  * @返回值 无
+  */
+void MinipBusAdaptiveWaitInit(MinipBus *bus, uint8_t enable)
+{
+	bus->adaptive_wait = enable ? 1 : 0;
+}
+
+/** 
+  * @描述   执行一次动态地址分配操作，使用方法为：总线上新接入一台雷达，调用一次此函数。
+  *         维护一个总线上的雷达集合，集合中的雷达从机地址均不相同，范围[1, 127]。
+  *         当函数调用时，发现总线上有一台默认从机地址的雷达时，将为该雷达分配一个新的地址，并加入所维护的雷达集合中。
+  * @参数   bus：总线句柄
+  * @参数   default_addr：雷达的默认从机地址
+  * @参数   list：设备列表，由调用者提供，为NULL时只更新总线的设备集合
+  * @返回值 总线上的设备数量
+  */
+uint8_t MinipBusAddrDynamicAllocation(MinipBus *bus, uint8_t default_addr, MinipDevListStruct *list)
+{
+	uint8_t num = MinipBusI2cScanBus(bus, NULL);
+	// 检查当前的设备集合中是否有默认地址
+	if(MinipAddrSetContains(&bus->dev_set, default_addr))
+	{
+		// 寻找一个地址，不在当前设备集合、不在排除集合、不是默认地址
+		MinipAddrSetStruct used = bus->dev_set;
+		for(uint8_t w = 0; w < 4; w++)
+		{
+			used.bits[w] |= bus->ex_set.bits[w];
+		}
+		MinipAddrSetInsert(&used, default_addr);
+
+		uint8_t new_addr = MinipAddrSetFindFree(&used);
+		if(0 != new_addr)
+		{
+			(void)MinipBusSetSlaveAddr(bus, default_addr, new_addr);
+			num = MinipBusI2cScanBus(bus, NULL);  // 修改从机地址后，重新扫描一次总线。
+		}
+	}
+
+	if(NULL != list)
+	{
+		(void)MinipAddrSetToList(&bus->dev_set, list);
+	}
+	return num;
+}
+
+/** 
+  * @描述   添加从机地址的排除列表。由于I2C总线上可能挂着除TFMINI PLUS之外的设备，因此操作总线时，排除这些设备的地址
+  * @参数   bus：总线句柄
+  * @参数   num：排除地址的个数
+  * @参数   ex_list：排除地址的列表，uint8_t型的数组
+  * @返回值 无
+  */
+void MinipBusAddrExclude(MinipBus *bus, uint8_t num, uint8_t *ex_list)
+{
+	MinipAddrSetClear(&bus->ex_set);
+	for(uint8_t n = 0; n < num; n++)
+	{
+		MinipAddrSetInsert(&bus->ex_set, ex_list[n]);
+	}
+}
+
+/** 
+  * @描述   使雷达的配置缓存失效，之后的读取函数将重新访问总线。雷达在本驱动之外被修改配置时使用，
+  *         也可以在读取前调用，强制读取雷达的实际配置。
+  * @参数   bus：总线句柄
+  * @参数   addr：从机地址，为0时对所有雷达有效
+  * @参数   mask：失效的配置项，见MINIP_CACHE_xxx
+  * @返回值 无
+  */
+void MinipBusCacheInvalidate(MinipBus *bus, uint8_t addr, uint8_t mask)
+{
+	cache_store(bus, addr, mask, NULL, I2C_ERROR);
+}
+
+/** 
+  * @描述   读取雷达测距结果函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址
+  * @参数   data：测距结果结构体指针
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t MinipBusReadData(MinipBus *bus, uint8_t addr, MinipDataStruct *data)
+{
+	uint8_t ack[MINIP_DATA_LEN];
+	uint8_t ret = i2c_transcieve(bus, addr, minip_cmd_read_data, sizeof(minip_cmd_read_data), ack, MINIP_DATA_LEN, 0);
+	if(I2C_OK == ret)
+	{
+		ret = decode_data(bus, addr, ack, data);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   批量读取测距结果的实现。结果和状态按各自的步长写入，使同一实现可以直接填充不同的输出结构，无需中间缓存。
+  * @参数   bus：总线句柄
+  * @参数   addr_list：雷达从机地址列表
+  * @参数   n：雷达数量，不超过MINIP_LIST_MAX，超出的雷达不处理
+  * @参数   data：第一台雷达测距结果的存放地址
+  * @参数   data_step：相邻两台雷达测距结果之间的字节间隔
+  * @参数   status：第一台雷达读取结果的存放地址，可以为NULL
+  * @参数   status_step：相邻两台雷达读取结果之间的字节间隔
+  * @返回值 全部读取成功返回I2C_OK，否则返回最后一个失败雷达的状态
+  */
+static uint8_t read_data_many(MinipBus *bus, uint8_t *addr_list, uint8_t n, MinipDataStruct *data, uint32_t data_step, uint8_t *status, uint32_t status_step)
+{
+	uint8_t  ack[MINIP_DATA_LEN];
+	uint32_t sent[MINIP_LIST_MASK_NUM] = {0};  // 按序号记录指令发送成功的雷达
+	uint8_t  ret = I2C_OK;
+	uint8_t  st;
+
+	if(n > MINIP_LIST_MAX)
+	{
+		n = MINIP_LIST_MAX;  // 按序号记录的标志只有MINIP_LIST_MAX位
+	}
+
+	// 第一阶段：向所有雷达发送指令
+	for(uint8_t k = 0; k < n; k++)
+	{
+		st = i2c_write(bus, addr_list[k], minip_cmd_read_data, sizeof(minip_cmd_read_data));
+		if(I2C_OK == st)
+		{
+			sent[k >> 5] |= 1UL << (k & 31);
+		}
+		else
+		{
+			ret = st;
+			if(NULL != status)
+			{
+				status[k * status_step] = st;
+			}
+		}
+	}
+
+	// 第二阶段：依次读回指令发送成功的雷达的应答
+	for(uint8_t k = 0; k < n; k++)
+	{
+		if(0 == (sent[k >> 5] & (1UL << (k & 31))))
+		{
+			continue;
+		}
+		st = i2c_read(bus, addr_list[k], ack, MINIP_DATA_LEN);
+		if(I2C_OK == st)
+		{
+			st = decode_data(bus, addr_list[k], ack, (MinipDataStruct*)((uint8_t*)data + k * data_step));
+		}
+		if(I2C_OK != st)
+		{
+			ret = st;
+		}
+		if(NULL != status)
+		{
+			status[k * status_step] = st;
+		}
+	}
+	return ret;
+}
+
+/** 
+  * @描述   批量读取多台雷达的测距结果。分两个阶段进行：先向所有雷达发送获取数据帧指令，再依次读回所有应答，
+  *         雷达准备应答的时间与其他雷达的总线传输重叠，总线时间接近N台雷达的纯传输时间。
+  * @参数   bus：总线句柄
+  * @参数   addr_list：雷达从机地址列表
+  * @参数   n：雷达数量，不超过MINIP_LIST_MAX，超出的雷达不处理
+  * @参数   data：测距结果数组，长度不小于n
+  * @参数   status：每台雷达的读取结果数组，长度不小于n，不需要时可以为NULL
+  * @返回值 全部读取成功返回I2C_OK，否则返回最后一个失败雷达的状态
+  */
+uint8_t MinipBusReadDataMany(MinipBus *bus, uint8_t *addr_list, uint8_t n, MinipDataStruct *data, uint8_t *status)
+{
+	return read_data_many(bus, addr_list, n, data, sizeof(MinipDataStruct), status, 1);
+}
+
+/** 
+  * @描述   按健康状态批量读取测距结果：选出本周期需要轮询的雷达，批量读取，再报告每台雷达的结果
+  * @参数   bus：总线句柄
+  * @参数   poll：本周期轮询的地址列表，由调用者提供，data和status与之一一对应
+  * @参数   data：测距结果数组，长度不小于设备集合中的雷达数量(最多127)
+  * @参数   status：每台雷达的读取结果数组，长度同data
+  * @返回值 本周期轮询的雷达数量
+  */
+uint8_t MinipBusReadDataHealthy(MinipBus *bus, MinipDevListStruct *poll, MinipDataStruct *data, uint8_t *status)
+{
+	uint8_t n = MinipBusHealthSelect(bus, poll);
+	(void)MinipBusReadDataMany(bus, poll->addr_list, n, data, status);
+	for(uint8_t k = 0; k < n; k++)
+	{
+		MinipBusHealthReport(bus, poll->addr_list[k], status[k]);
+	}
+	return n;
+}
+
+/** 
+  * @描述   进入同步采集模式，将列表中的雷达全部设为单次触发模式，并清零周期编号
+  * @参数   bus：总线句柄
+  * @参数   addr_list：雷达从机地址列表
+  * @参数   n：雷达数量，不超过MINIP_LIST_MAX，超出的雷达不处理
+  * @返回值 全部设置成功返回I2C_OK，否则返回最后一个失败雷达的状态
+  */
+uint8_t MinipBusSyncStart(MinipBus *bus, uint8_t *addr_list, uint8_t n)
+{
+	MinipConfig cfg = {.rate = 0};
+	uint8_t ret = config_write_many(bus, addr_list, n, NULL, MINIP_CFG_RATE, &cfg, NULL, 0);
+	bus->sync_cycle = 0;
+	return ret;
+}
+
+/** 
+  * @描述   执行一个同步采集周期：触发所有雷达测量，等待测量完成，再批量读回结果。
+  *         所有雷达在同一时刻附近开始测量，样本之间不再有帧相位差。
+  * @参数   bus：总线句柄
+  * @参数   addr_list：雷达从机地址列表，雷达须已通过MinipBusSyncStart进入单次触发模式
+  * @参数   n：雷达数量，不超过MINIP_LIST_MAX，超出的雷达不处理
+  * @参数   mode：触发方式，见MinipTrigModeEnum
+  * @参数   sample：样本数组，长度不小于n，每个样本带有本周期的编号
+  * @返回值 全部读取成功返回I2C_OK，否则返回最后一个失败雷达的状态
+  */
+uint8_t MinipBusSyncCapture(MinipBus *bus, uint8_t *addr_list, uint8_t n, uint8_t mode, MinipSyncSampleStruct *sample)
+{
+	uint8_t ret;
+
+	if((MINIP_TRIG_STAGGER == mode) || (I2C_OK != MinipBusSampleTrig(bus, 0)))
+	{
+		for(uint8_t k = 0; k < n; k++)
+		{
+			(void)MinipBusSampleTrig(bus, addr_list[k]);
+		}
+	}
+	bus->delay_ms_func(MINIP_SYNC_SETTLE_MS);
+
+	for(uint8_t k = 0; k < n; k++)
+	{
+		sample[k].cycle = bus->sync_cycle;
+	}
+	ret = read_data_many(bus, addr_list, n, &sample[0].data, sizeof(MinipSyncSampleStruct), &sample[0].status, sizeof(MinipSyncSampleStruct));
+	bus->sync_cycle++;
+	return ret;
+}
+
+/** 
+  * @描述   退出同步采集模式，将列表中的雷达恢复为指定帧率的连续测量
+  * @参数   bus：总线句柄
+  * @参数   addr_list：雷达从机地址列表
+  * @参数   n：雷达数量，不超过MINIP_LIST_MAX，超出的雷达不处理
+  * @参数   rate：恢复的帧率
+  * @返回值 全部设置成功返回I2C_OK，否则返回最后一个失败雷达的状态
+  */
+uint8_t MinipBusSyncStop(MinipBus *bus, uint8_t *addr_list, uint8_t n, uint16_t rate)
+{
+	MinipConfig cfg = {.rate = rate};
+	return config_write_many(bus, addr_list, n, NULL, MINIP_CFG_RATE, &cfg, NULL, 0);
+}
+
+/** 
+  * @描述   读取雷达固件版本号函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址
+  * @参数   verion：固件版本号结构体指针
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t MinipBusReadVersion(MinipBus *bus, uint8_t addr, MinipFirmwareVersion *verion)
+{
+	MinipCacheStruct *cache = cache_find(bus, addr);
+	MinipCacheStruct val;
+	uint8_t ack[7];
+
+	if((NULL != cache) && (cache->valid & MINIP_CACHE_VERSION))
+	{
+		*verion = cache->version;
+		return I2C_OK;
+	}
+	uint8_t ret = i2c_query(bus, addr, minip_cmd_read_version, sizeof(minip_cmd_read_version), ack, sizeof(ack));
+	if(I2C_OK == ret)
+	{
+		verion->major = ack[5];
+		verion->minor = ack[4];
+		verion->revision = ack[3];
+		val.version = *verion;
+		cache_store(bus, addr, MINIP_CACHE_VERSION, &val, ret);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   软件复位雷达函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusSoftReset(MinipBus *bus, uint8_t addr)
+{
+	// 复位后雷达恢复为已保存的配置，与缓存不一定相同
+	cache_store(bus, addr, MINIP_CACHE_CONFIG, NULL, I2C_ERROR);
+	return cmd_write(bus, addr, minip_cmd_soft_reset, sizeof(minip_cmd_soft_reset));
+}
+
+/** 
+  * @描述   设定雷达帧率函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @参数   rate：帧率，范围1-1000，雷达可实现的帧率为1000/n，n为正整数。当rate为0时，雷达进入单次触发模式
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusSetSampleRate(MinipBus *bus, uint8_t addr, uint16_t rate)
+{
+	MinipConfig cfg = {.rate = rate};
+	return config_write(bus, addr, MINIP_CFG_RATE, &cfg);
+}
+
+/** 
+  * @描述   读取雷达帧率函数。
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址
+  * @参数   rate：帧率指针
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t MinipBusGetSampleRate(MinipBus *bus, uint8_t addr, uint16_t *rate)
+{
+	MinipCacheStruct *cache = cache_find(bus, addr);
+	MinipCacheStruct val;
+	uint8_t ack[6];
+
+	if((NULL != cache) && (cache->valid & MINIP_CACHE_RATE))
+	{
+		*rate = cache->rate;
+		return I2C_OK;
+	}
+	uint8_t ret = i2c_query(bus, addr, minip_cmd_get_sample_rate, sizeof(minip_cmd_get_sample_rate), ack, sizeof(ack));
+	if(I2C_OK == ret)
+	{
+		*rate = (uint16_t)ack[3] + (((uint16_t)ack[4]) << 8);
+		val.rate = *rate;
+		cache_store(bus, addr, MINIP_CACHE_RATE, &val, ret);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   对雷达进行单次触发函数，只有当雷达帧率为0，即单次触发模式下，此函数才有效
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusSampleTrig(MinipBus *bus, uint8_t addr)
+{
+	return i2c_write(bus, addr, minip_cmd_sample_trig, sizeof(minip_cmd_sample_trig));
+}
+
+/** 
+  * @描述   使能雷达函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusEnable(MinipBus *bus, uint8_t addr)
+{
+	MinipConfig cfg = {.en = 1};
+	return config_write(bus, addr, MINIP_CFG_EN, &cfg);
+}
+
+/** 
+  * @描述   关闭雷达函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusDisable(MinipBus *bus, uint8_t addr)
+{
+	MinipConfig cfg = {.en = 0};
+	return config_write(bus, addr, MINIP_CFG_EN, &cfg);
+}
+
+/** 
+  * @描述   获取雷达状态函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址
+  * @参数   status：状态指针，0雷达关闭，1雷达使能
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusGetStatus(MinipBus *bus, uint8_t addr, uint8_t *status)
+{
+	MinipCacheStruct *cache = cache_find(bus, addr);
+	MinipCacheStruct val;
+	uint8_t ack[5];
+
+	if((NULL != cache) && (cache->valid & MINIP_CACHE_EN))
+	{
+		*status = cache->en;
+		return I2C_OK;
+	}
+	uint8_t ret = i2c_query(bus, addr, minip_cmd_get_status, sizeof(minip_cmd_get_status), ack, sizeof(ack));
+	if(I2C_OK == ret)
+	{
+		*status = ack[3];
+		val.en = *status;
+		cache_store(bus, addr, MINIP_CACHE_EN, &val, ret);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   修改雷达从机地址函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址
+  * @参数   new_addr：新的从机地址，范围1-127
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusSetSlaveAddr(MinipBus *bus, uint8_t addr, uint8_t new_addr)
+{
+	uint8_t cmd[sizeof(minip_cmd_set_slave_addr)];
+	memcpy(cmd, minip_cmd_set_slave_addr, sizeof(cmd));
+	MINIP_CMD_PATCH(cmd, 3, new_addr);
+	// 雷达改用新地址后，原地址的缓存不再对应任何雷达，新地址在重新扫描时建立记录
+	cache_store(bus, addr, MINIP_CACHE_ALL, NULL, I2C_ERROR);
+	return cmd_write(bus, addr, cmd, sizeof(cmd));
+}
+
+/** 
+  * @描述   恢复出厂设置函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusRestoreDefault(MinipBus *bus, uint8_t addr)
+{
+	cache_store(bus, addr, MINIP_CACHE_CONFIG, NULL, I2C_ERROR);
+	return cmd_write(bus, addr, minip_cmd_restore_default, sizeof(minip_cmd_restore_default));
+}
+
+/** 
+  * @描述   保存当前设置函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusSaveSettings(MinipBus *bus, uint8_t addr)
+{
+	return cmd_write(bus, addr, minip_cmd_save_settings, sizeof(minip_cmd_save_settings));
+}
+
+/** 
+  * @描述   设置雷达AMP阈值函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @参数   amp_th：AMP踢点阈值，数值为实际AMP阈值的10分之1，即实际阈值为amp_th*10，AMP低于该值时，距离值输出为0
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusSetAmpThreshold(MinipBus *bus, uint8_t addr, uint8_t amp_th)
+{
+	MinipConfig cfg = {.amp_th = amp_th};
+	return config_write(bus, addr, MINIP_CFG_AMP_TH, &cfg);
+}
+
+/** 
+  * @描述   获取雷达AMP阈值函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址
+  * @参数   amp_th：AMP踢点阈值指针，数值为实际AMP阈值的10分之1
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusGetAmpThreshold(MinipBus *bus, uint8_t addr, uint8_t *amp_th)
+{
+	MinipCacheStruct *cache = cache_find(bus, addr);
+	MinipCacheStruct val;
+	uint8_t ack[5];
+
+	if((NULL != cache) && (cache->valid & MINIP_CACHE_AMP_TH))
+	{
+		*amp_th = cache->amp_th;
+		return I2C_OK;
+	}
+	uint8_t ret = i2c_query(bus, addr, minip_cmd_get_amp_th, sizeof(minip_cmd_get_amp_th), ack, sizeof(ack));
+	if(I2C_OK == ret)
+	{
+		*amp_th = ack[3];
+		val.amp_th = *amp_th;
+		cache_store(bus, addr, MINIP_CACHE_AMP_TH, &val, ret);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   设置距离限制函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @参数   min：雷达输出的最小距离值，单位cm
+  * @参数   max：雷达输出的最大距离值，单位cm
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusSetDistLimit(MinipBus *bus, uint8_t addr, uint16_t min, uint16_t max)
+{
+	MinipConfig cfg = {.dist_min = min, .dist_max = max};
+	return config_write(bus, addr, MINIP_CFG_DIST_LIMIT, &cfg);
+}
+
+/** 
+  * @描述   获取距离限制值函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址
+  * @参数   min：雷达输出的最小距离值指针，单位cm
+  * @参数   max：雷达输出的最大距离值指针，单位cm
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusGetDistLimit(MinipBus *bus, uint8_t addr, uint16_t *min, uint16_t *max)
+{
+	MinipCacheStruct *cache = cache_find(bus, addr);
+	MinipCacheStruct val;
+	uint8_t ack[9];
+
+	if((NULL != cache) && (cache->valid & MINIP_CACHE_DIST_LIMIT))
+	{
+		*min = cache->dist_min;
+		*max = cache->dist_max;
+		return I2C_OK;
+	}
+	uint8_t ret = i2c_query(bus, addr, minip_cmd_get_dist_limit, sizeof(minip_cmd_get_dist_limit), ack, sizeof(ack));
+	if(I2C_OK == ret)
+	{
+		*min = (uint16_t)ack[3] + (((uint16_t)ack[4]) << 8);
+		*max = (uint16_t)ack[5] + (((uint16_t)ack[6]) << 8);
+		val.dist_min = *min;
+		val.dist_max = *max;
+		cache_store(bus, addr, MINIP_CACHE_DIST_LIMIT, &val, ret);
+	}
+	return ret;
+}
+
+/** 
+  * @描述   Minip时间戳同步函数
+  * @参数   bus：总线句柄
+  * @参数   addr：指定雷达的从机地址，当addr为0时，对总线上的所有雷达有效
+  * @参数   std：指定的当前时间，单位ms
+  * @返回值 数据传输状态，I2C_OK或详细错误状态
+  */
+uint8_t  MinipBusTimestampSync(MinipBus *bus, uint8_t addr, uint32_t std)
+{
+	uint8_t cmd[sizeof(minip_cmd_timestamp)];
+	memcpy(cmd, minip_cmd_timestamp, sizeof(cmd));
+	MINIP_CMD_PATCH(cmd, 3, std & 0xFF);
+	MINIP_CMD_PATCH(cmd, 4, (std >> 8) & 0xFF);
+	MINIP_CMD_PATCH(cmd, 5, (std >> 16) & 0xFF);
+	MINIP_CMD_PATCH(cmd, 6, (std >> 24) & 0xFF);
+	return i2c_write(bus, addr, cmd, sizeof(cmd));
+}
+
+/* 批量配置时读取当前配置的查询指令、指令长度和应答长度，按MinipConfigFieldEnum排列 */
+static const uint8_t *const config_query_cmd[MINIP_CFG_NUM] =
+{
+	minip_cmd_get_sample_rate, minip_cmd_get_status, minip_cmd_get_amp_th, minip_cmd_get_dist_limit
+};
+static const uint8_t config_query_len[MINIP_CFG_NUM] =
+{
+	sizeof(minip_cmd_get_sample_rate), sizeof(minip_cmd_get_status), sizeof(minip_cmd_get_amp_th), sizeof(minip_cmd_get_dist_limit)
+};
+static const uint8_t config_ack_len[MINIP_CFG_NUM] = {6, 5, 5, 9};
+
+/** 
+  * @描述   从查询应答中解析一个配置项
+  * @参数   field：配置项，见MinipConfigFieldEnum
+  * @参数   ack：已校验的应答帧
+  * @参数   val：解析结果，只写入该配置项
+  * @返回值 无
+  */
+static void config_decode(uint8_t field, const uint8_t *ack, MinipCacheStruct *val)
+{
+	switch(field)
+	{
+		case MINIP_CFG_RATE:
+			val->rate = (uint16_t)ack[3] + (((uint16_t)ack[4]) << 8);
+			break;
+		case MINIP_CFG_EN:
+			val->en = ack[3];
+			break;
+		case MINIP_CFG_AMP_TH:
+			val->amp_th = ack[3];
+			break;
+		case MINIP_CFG_DIST_LIMIT:
+			val->dist_min = (uint16_t)ack[3] + (((uint16_t)ack[4]) << 8);
+			val->dist_max = (uint16_t)ack[5] + (((uint16_t)ack[6]) << 8);
+			break;
+		default:
+			break;
+	}
+}
+
+/** 
+  * @描述   判断雷达的一个配置项是否已经是期望值
+  * @参数   cache：雷达的配置缓存，可以为NULL
+  * @参数   field：配置项，见MinipConfigFieldEnum
+  * @参数   cfg：期望的配置
+  * @返回值 1缓存有效且与期望值相同，0需要发送设置指令
+  */
+static uint8_t config_equal(const MinipCacheStruct *cache, uint8_t field, const MinipConfig *cfg)
+{
+	if((NULL == cache) || (0 == (cache->valid & (1 << field))))
+	{
+		return 0;
+	}
+	switch(field)
+	{
+		case MINIP_CFG_RATE:
+			return (cache->rate == cfg->rate) ? 1 : 0;
+		case MINIP_CFG_EN:
+			return (cache->en == cfg->en) ? 1 : 0;
+		case MINIP_CFG_AMP_TH:
+			return (cache->amp_th == cfg->amp_th) ? 1 : 0;
+		case MINIP_CFG_DIST_LIMIT:
+			return ((cache->dist_min == cfg->dist_min) && (cache->dist_max == cfg->dist_max)) ? 1 : 0;
+		default:
+			return 0;
+	}
+}
+
+/** 
+  * @描述   批量配置时查找雷达的当前配置
+  * @参数   bus：总线句柄
+  * @参数   result：雷达的配置结果
+  * @返回值 雷达的配置缓存，没有健康记录的雷达(超出MINIP_MAX_DEV)返回配置结果中的当前配置
+  */
+static MinipCacheStruct *apply_cache(MinipBus *bus, MinipConfigResultStruct *result)
+{
+	MinipCacheStruct *cache = cache_find(bus, result->addr);
+	return (NULL != cache) ? cache : &result->cur;
+}
+
+/** 
+  * @描述   批量配置雷达，分三个阶段完成：
+  *         1.读取缓存中没有的当前配置，每个配置项向所有雷达发送查询指令后只等待一次，再依次读回应答；
+  *           没有健康记录的雷达每次都读取，读到的配置保存在result的cur中；
+  *         2.只对与期望值不同的配置项发送设置指令，按配置项轮流发给每台雷达，同一台雷达的相邻两条指令之间有其他雷达的传输，
+  *           开启校验时每个配置项只等待一次，再依次读回所有雷达的应答；
+  *         3.每台发送过设置指令的雷达保存一次设置，有配置项设置失败的雷达不保存，下次上电仍为原来的配置。
+  *         配置全部相同的雷达不发送任何指令，不写flash。
+  * @参数   bus：总线句柄
+  * @参数   addr_list：雷达从机地址列表，不能包含广播地址0
+  * @参数   n：雷达数量，不超过MINIP_LIST_MAX，超出的雷达不处理
+  * @参数   cfg：期望的配置
+  * @参数   result：配置结果数组，长度不小于n，同时作为没有健康记录的雷达的配置缓存
+  * @返回值 全部成功返回I2C_OK，否则返回最后一个失败的状态
+  */
+uint8_t MinipBusConfigApply(MinipBus *bus, uint8_t *addr_list, uint8_t n, const MinipConfig *cfg, MinipConfigResultStruct *result)
+{
+	uint8_t ack[9];
+	uint8_t ret = I2C_OK;
+	uint8_t st;
+
+	if(n > MINIP_LIST_MAX)
+	{
+		n = MINIP_LIST_MAX;  // 按序号记录的标志只有MINIP_LIST_MAX位
+	}
+
+	for(uint8_t k = 0; k < n; k++)
+	{
+		memset(&result[k], 0, sizeof(MinipConfigResultStruct));
+		result[k].addr = addr_list[k];
+	}
+
+	// 第一阶段：读取当前配置，读取失败的配置项视为与期望值不同
+	for(uint8_t field = 0; field < MINIP_CFG_NUM; field++)
+	{
+		uint8_t  bit = 1 << field;
+		uint32_t pending[MINIP_LIST_MASK_NUM] = {0};
+		uint8_t  wait = 0;
+
+		if(0 == (cfg->mask & bit))
+		{
+			continue;
+		}
+		for(uint8_t k = 0; k < n; k++)
+		{
+			if(apply_cache(bus, &result[k])->valid & bit)
+			{
+				continue;
+			}
+			if(I2C_OK == i2c_write(bus, addr_list[k], config_query_cmd[field], config_query_len[field]))
+			{
+				uint8_t t = ack_wait_get(bus, addr_list[k]);
+				pending[k >> 5] |= 1UL << (k & 31);
+				wait = (t > wait) ? t : wait;
+			}
+		}
+		if(0 == wait)
+		{
+			continue;
+		}
+		bus->delay_ms_func(wait);
+		for(uint8_t k = 0; k < n; k++)
+		{
+			MinipCacheStruct val;
+			if(0 == (pending[k >> 5] & (1UL << (k & 31))))
+			{
+				continue;
+			}
+			st = ack_read(bus, addr_list[k], ack, config_ack_len[field], config_query_cmd[field][3], wait);
+			if((I2C_OK == st) && (apply_cache(bus, &result[k]) == &result[k].cur))
+			{
+				config_decode(field, ack, &result[k].cur);
+				result[k].cur.valid |= bit;
+			}
+			else if(I2C_OK == st)
+			{
+				config_decode(field, ack, &val);
+				cache_store(bus, addr_list[k], bit, &val, st);
+			}
+		}
+	}
+
+	// 第二阶段：按配置项轮流发送设置指令
+	for(uint8_t field = 0; field < MINIP_CFG_NUM; field++)
+	{
+		uint8_t  bit = 1 << field;
+		uint32_t sel[MINIP_LIST_MASK_NUM] = {0};
+		uint8_t  change = 0;
+
+		if(0 == (cfg->mask & bit))
+		{
+			continue;
+		}
+		for(uint8_t k = 0; k < n; k++)
+		{
+			if(!config_equal(apply_cache(bus, &result[k]), field, cfg))
+			{
+				sel[k >> 5] |= 1UL << (k & 31);
+				result[k].sent |= bit;
+				change = 1;
+			}
+		}
+		if(change)
+		{
+			st = config_write_many(bus, addr_list, n, sel, field, cfg, &result[0].status[field], sizeof(MinipConfigResultStruct));
+			if(I2C_OK != st)
+			{
+				ret = st;
+			}
+		}
+	}
+
+	// 第三阶段：每台雷达保存一次设置
+	uint32_t sel[MINIP_LIST_MASK_NUM] = {0};
+	uint8_t  save = 0;
+	for(uint8_t k = 0; k < n; k++)
+	{
+		if(0 == result[k].sent)
+		{
+			continue;
+		}
+		for(uint8_t field = 0; field < MINIP_CFG_NUM; field++)
+		{
+			if(I2C_OK != result[k].status[field])
+			{
+				result[k].save = result[k].status[field];
+				break;
+			}
+		}
+		if(I2C_OK == result[k].save)
+		{
+			sel[k >> 5] |= 1UL << (k & 31);
+			save = 1;
+		}
+	}
+	if(save)
+	{
+		st = cmd_write_many(bus, addr_list, n, sel, minip_cmd_save_settings, sizeof(minip_cmd_save_settings), NULL, &result[0].save, sizeof(MinipConfigResultStruct));
+		if(I2C_OK != st)
+		{
+			ret = st;
+		}
+	}
+	return ret;
+}
+
+/**
+  ******************************************************************************
+  * 单总线接口，以下函数操作默认总线
+  ******************************************************************************
+  */
+
+/** 
+  * @描述   获取默认总线的句柄，便于单总线接口与多总线接口混合使用
+  * @参数   无
+  * @返回值 默认总线句柄
+  */
+MinipBus *MinipDefaultBus(void)
+{
+	return &sDefaultBus;
+}
+
+void MinipI2cInit(I2cWriteFuncPtr i2c_write, I2cReadFuncPtr i2c_read, I2cBusResetFuncPtr i2c_reset, DelayMsFuncPtr delay_ms)
+{
+	MinipBusInit(&sDefaultBus, i2c_write, i2c_read, i2c_reset, delay_ms);
+}
+
+void MinipScanInit(I2cProbeFuncPtr probe, I2cBusStuckFuncPtr stuck)
+{
+	MinipBusScanInit(&sDefaultBus, probe, stuck);
+}
+
+uint8_t MinipI2cScanBus(MinipDevListStruct *list)
+{
+	return MinipBusI2cScanBus(&sDefaultBus, list);
+}
+
+uint8_t MinipI2cScanHint(const MinipAddrSetStruct *hint, MinipDevListStruct *list)
+{
+	return MinipBusI2cScanHint(&sDefaultBus, hint, list);
+}
+
+void MinipHotplugInit(uint8_t step, DevEventFuncPtr event)
+{
+	MinipBusHotplugInit(&sDefaultBus, step, event);
+}
+
+uint8_t MinipHotplugStep(MinipDevListStruct *list)
+{
+	return MinipBusHotplugStep(&sDefaultBus, list);
+}
+
+uint8_t MinipHealthSelect(MinipDevListStruct *poll)
+{
+	return MinipBusHealthSelect(&sDefaultBus, poll);
+}
+
+uint8_t MinipHealthFilter(MinipDevListStruct *poll)
+{
+	return MinipBusHealthFilter(&sDefaultBus, poll);
+}
+
+void MinipHealthReport(uint8_t addr, uint8_t status)
+{
+	MinipBusHealthReport(&sDefaultBus, addr, status);
+}
+
+uint8_t MinipHealthGet(uint8_t addr)
+{
+	return MinipBusHealthGet(&sDefaultBus, addr);
+}
+
+void MinipGetBusStat(uint32_t *status_cnt)
+{
+	MinipBusGetBusStat(&sDefaultBus, status_cnt);
+}
+
+uint8_t MinipGetAddrStat(uint8_t addr, uint32_t *status_cnt)
+{
+	return MinipBusGetAddrStat(&sDefaultBus, addr, status_cnt);
+}
+
+void MinipClearStat(void)
+{
+	MinipBusClearStat(&sDefaultBus);
+}
+
+void MinipTimingInit(TickFuncPtr tick, uint32_t tick_per_us)
+{
+	MinipBusTimingInit(&sDefaultBus, tick, tick_per_us);
+}
+
+void MinipVerifyInit(uint8_t enable)
+{
+	MinipBusVerifyInit(&sDefaultBus, enable);
+}
+
+void MinipAdaptiveWaitInit(uint8_t enable)
+{
+	MinipBusAdaptiveWaitInit(&sDefaultBus, enable);
+}
+
+uint8_t MinipAddrDynamicAllocation(uint8_t default_addr, MinipDevListStruct *list)
+{
+	return MinipBusAddrDynamicAllocation(&sDefaultBus, default_addr, list);
+}
+
+void MinipAddrExclude(uint8_t num, uint8_t *ex_list)
+{
+	MinipBusAddrExclude(&sDefaultBus, num, ex_list);
+}
+
+void MinipCacheInvalidate(uint8_t addr, uint8_t mask)
+{
+	MinipBusCacheInvalidate(&sDefaultBus, addr, mask);
+}
+
+uint8_t MinipReadData(uint8_t addr, MinipDataStruct *data)
+{
+	return MinipBusReadData(&sDefaultBus, addr, data);
+}
 
-	uint8_t cmd[8] = {0x5A, 8, 0x31};
-	cmd[3] = std & 0xFF;
-	cmd[4] = (std >> 8) & 0xFF;
-	cmd[5] = (std >> 16) & 0xFF;
-	cmd[6] = (std >> 24) & 0xFF;
-	cmd[7] = 0;
-	return i2c_write_func(addr, cmd, 8);
+uint8_t MinipReadDataMany(uint8_t *addr_list, uint8_t n, MinipDataStruct *data, uint8_t *status)
+{
+	return MinipBusReadDataMany(&sDefaultBus, addr_list, n, data, status);
+}
+
+uint8_t MinipReadDataHealthy(MinipDevListStruct *poll, MinipDataStruct *data, uint8_t *status)
+{
+	return MinipBusReadDataHealthy(&sDefaultBus, poll, data, status);
+}
+
+uint8_t MinipSyncStart(uint8_t *addr_list, uint8_t n)
+{
+	return MinipBusSyncStart(&sDefaultBus, addr_list, n);
+}
+
+uint8_t MinipSyncCapture(uint8_t *addr_list, uint8_t n, uint8_t mode, MinipSyncSampleStruct *sample)
+{
+	return MinipBusSyncCapture(&sDefaultBus, addr_list, n, mode, sample);
+}
+
+uint8_t MinipSyncStop(uint8_t *addr_list, uint8_t n, uint16_t rate)
+{
+	return MinipBusSyncStop(&sDefaultBus, addr_list, n, rate);
+}
+
+uint8_t MinipReadVersion(uint8_t addr, MinipFirmwareVersion *verion)
+{
+	return MinipBusReadVersion(&sDefaultBus, addr, verion);
+}
+
+uint8_t MinipSoftReset(uint8_t addr)
+{
+	return MinipBusSoftReset(&sDefaultBus, addr);
+}
+
+uint8_t MinipSetSampleRate(uint8_t addr, uint16_t rate)
+{
+	return MinipBusSetSampleRate(&sDefaultBus, addr, rate);
+}
+
+uint8_t MinipGetSampleRate(uint8_t addr, uint16_t *rate)
+{
+	return MinipBusGetSampleRate(&sDefaultBus, addr, rate);
+}
+
+uint8_t MinipSampleTrig(uint8_t addr)
+{
+	return MinipBusSampleTrig(&sDefaultBus, addr);
+}
+
+uint8_t MinipEnable(uint8_t addr)
+{
+	return MinipBusEnable(&sDefaultBus, addr);
+}
+
+uint8_t MinipDisable(uint8_t addr)
+{
+	return MinipBusDisable(&sDefaultBus, addr);
+}
+
+uint8_t MinipGetStatus(uint8_t addr, uint8_t *status)
+{
+	return MinipBusGetStatus(&sDefaultBus, addr, status);
+}
+
+uint8_t MinipSetSlaveAddr(uint8_t addr, uint8_t new_addr)
+{
+	return MinipBusSetSlaveAddr(&sDefaultBus, addr, new_addr);
+}
+
+uint8_t MinipRestoreDefault(uint8_t addr)
+{
+	return MinipBusRestoreDefault(&sDefaultBus, addr);
+}
+
+uint8_t MinipSaveSettings(uint8_t addr)
+{
+	return MinipBusSaveSettings(&sDefaultBus, addr);
 }
 
+uint8_t MinipSetAmpThreshold(uint8_t addr, uint8_t amp_th)
+{
+	return MinipBusSetAmpThreshold(&sDefaultBus, addr, amp_th);
+}
+
+uint8_t MinipGetAmpThreshold(uint8_t addr, uint8_t *amp_th)
+{
+	return MinipBusGetAmpThreshold(&sDefaultBus, addr, amp_th);
+}
+
+uint8_t MinipSetDistLimit(uint8_t addr, uint16_t min, uint16_t max)
+{
+	return MinipBusSetDistLimit(&sDefaultBus, addr, min, max);
+}
 
+uint8_t MinipGetDistLimit(uint8_t addr, uint16_t *min, uint16_t *max)
+{
+	return MinipBusGetDistLimit(&sDefaultBus, addr, min, max);
+}
+
+uint8_t MinipTimestampSync(uint8_t addr, uint32_t std)
+{
+	return MinipBusTimestampSync(&sDefaultBus, addr, std);
+}
+
+uint8_t MinipConfigApply(uint8_t *addr_list, uint8_t n, const MinipConfig *cfg, MinipConfigResultStruct *result)
+{
+	return MinipBusConfigApply(&sDefaultBus, addr_list, n, cfg, result);
+}
@@ -6,16 +6,27 @@
 #endif 
 
 #include <stdint.h>
+#include "tfminip_perf.h"
 
-#define I2C_OK      (0)
-#define I2C_ERROR   (1)
+#define I2C_OK          (0)
+#define I2C_ERROR       (1)   // 未能细分的错误
+#define I2C_FRAME_ERROR (2)   // 总线传输成功，但应答帧的帧头、长度、ID或校验和错误
+#define I2C_ADDR_NACK   (3)   // 从机地址无应答
+#define I2C_DATA_NACK   (4)   // 从机地址有应答，但数据字节无应答
+#define I2C_TIMEOUT     (5)   // 传输或等待超时
+#define I2C_BUS_ERROR   (6)   // 总线错误，检测到非法的起始或停止条件
+#define I2C_ARB_LOST    (7)   // 仲裁丢失
+#define I2C_NOT_INIT    (8)   // 总线未初始化
+#define I2C_BUSY        (9)   // 总线上有其他传输正在进行
+#define I2C_VERIFY_ERROR (10) // 配置指令的应答帧正确，但内容与指令不符，或雷达报告执行失败
+#define MINIP_STATUS_NUM (11) // 状态种类数量
 
 /** 
   * @描述   I2C主机写函数原型
   * @参数1  I2C从机地址
   * @参数2  数据所在的内存地址
   * @参数3  需要发送的数据量，单位Byte
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @返回值 数据传输状态，I2C_OK或详细错误状态，不能细分时返回I2C_ERROR
   */
 typedef uint8_t (*I2cWriteFuncPtr)(uint8_t, uint8_t*, uint32_t);
 
@@ -24,7 +35,7 @@ typedef uint8_t (*I2cWriteFuncPtr)(uint8_t, uint8_t*, uint32_t);
   * @参数1  I2C从机地址
   * @参数2  目标内存地址
   * @参数3  需要读的数据量，单位Byte
-  * @返回值 数据传输状态，I2C_OK或I2C_ERROR
+  * @返回值 数据传输状态，I2C_OK或详细错误状态，不能细分时返回I2C_ERROR
   */
 typedef uint8_t (*I2cReadFuncPtr)(uint8_t, uint8_t*, uint32_t);
 
@@ -36,6 +47,28 @@ typedef uint8_t (*I2cReadFuncPtr)(uint8_t, uint8_t*, uint32_t);
   */
 typedef void (*I2cBusResetFuncPtr)(void);
 
+/** 
+  * @描述   I2C从机地址探测函数，只发送从机地址，不发送任何数据字节，从机不会收到指令
+  * @参数   I2C从机地址
+  * @返回值 I2C_OK从机应答，I2C_ADDR_NACK从机无应答，或其他详细错误状态
+  */
+typedef uint8_t (*I2cProbeFuncPtr)(uint8_t);
+
+/** 
+  * @描述   I2C总线卡死检测函数，用于判断是否需要调用I2cBusResetFuncPtr恢复总线
+  * @参数   无
+  * @返回值 1总线卡死(SDA或SCL被拉低，或I2C模块处于忙状态)，0总线空闲
+  */
+typedef uint8_t (*I2cBusStuckFuncPtr)(void);
+
+/** 
+  * @描述   设备变化通知函数，总线上出现新设备或已知设备消失时被调用
+  * @参数1  I2C从机地址
+  * @参数2  事件，见MinipDevEventEnum
+  * @返回值 无
+  */
+typedef void (*DevEventFuncPtr)(uint8_t, uint8_t);
+
 /** 
   * @描述   延时函数
   * @参数   延时时间，单位ms
@@ -43,18 +76,108 @@ typedef void (*I2cBusResetFuncPtr)(void);
   */
 typedef void (*DelayMsFuncPtr)(uint32_t);
 
+/** 
+  * @描述   异步事务完成通知函数，在I2C中断中被调用，用于唤醒等待事务的任务
+  * @参数   无
+  * @返回值 无
+  */
+typedef void (*XferNotifyFuncPtr)(void);
+
+/** 
+  * @描述   异步事务等待函数，阻塞当前任务直到XferNotifyFuncPtr被调用或超时
+  * @参数   超时时间，单位ms
+  * @返回值 I2C_OK被唤醒，I2C_ERROR超时
+  */
+typedef uint8_t (*XferWaitFuncPtr)(uint32_t);
+
+#define MINIP_XFER_TIMEOUT_MS   (100)   // 异步事务的最长等待时间，单位ms
+#define MINIP_SYNC_SETTLE_MS    (2)     // 同步采集时，触发后等待雷达完成测量的时间，单位ms
+#define MINIP_ACK_WAIT_MS       (10)    // 配置指令发送后到读取应答的等待时间，自适应等待时为最长等待时间，单位ms
+#define MINIP_ACK_POLL_MS       (1)     // 自适应等待时重读应答的间隔，单位ms
+
+#ifndef MINIP_MAX_DEV
+#define MINIP_MAX_DEV           (16)    // 每条总线进行健康管理的最大雷达数量，超出的雷达不参与轮询
+#endif
+#define MINIP_LIST_MAX          (128)   // 批量读取和配置一次最多处理的雷达数量，即7位从机地址的数量，列表中超出的雷达不处理
+#define MINIP_LIST_MASK_NUM     ((MINIP_LIST_MAX + 31) / 32)   // 批量操作中按序号每台一位的标志所需的32位字数
+#define MINIP_HEALTH_RETRY_MAX  (5)     // 连续失败达到此次数后隔离雷达
+#define MINIP_HEALTH_BACKOFF_MAX (16)   // 重试退避和隔离的最长间隔，单位采集周期
+
+/* 配置缓存的有效标志 */
+#define MINIP_CACHE_RATE        (0x01)  // 帧率
+#define MINIP_CACHE_EN          (0x02)  // 使能状态
+#define MINIP_CACHE_AMP_TH      (0x04)  // AMP阈值
+#define MINIP_CACHE_DIST_LIMIT  (0x08)  // 距离限制
+#define MINIP_CACHE_VERSION     (0x10)  // 固件版本号
+#define MINIP_CACHE_CONFIG      (0x0F)  // 全部可设置的配置项，雷达复位或恢复出厂设置后失效
+#define MINIP_CACHE_ALL         (0x1F)
+
+/** 
+  * @描述  设备变化事件枚举
+  */
+typedef enum
+{
+	MINIP_DEV_ADDED = 0,     /*!< 总线上出现新设备 */
+	MINIP_DEV_REMOVED        /*!< 已知设备消失     */
+}MinipDevEventEnum;
+
+/** 
+  * @描述  雷达健康状态枚举
+  */
+typedef enum
+{
+	MINIP_HEALTH_OK = 0,        /*!< 正常，每个周期轮询                          */
+	MINIP_HEALTH_SUSPECT,       /*!< 失败一次，下个周期照常轮询                    */
+	MINIP_HEALTH_RETRYING,      /*!< 连续失败，按指数退避间隔若干周期后重试          */
+	MINIP_HEALTH_QUARANTINED,   /*!< 重试次数用尽，停止轮询，间隔最长退避周期后单独探测地址 */
+	MINIP_HEALTH_GONE           /*!< 探测无应答，已移出设备集合                    */
+}MinipHealthEnum;
+
+/** 
+  * @描述  异步事务的状态枚举
+  */
+typedef enum
+{
+	MINIP_XFER_IDLE = 0,     /*!< 未提交               */
+	MINIP_XFER_WRITE,        /*!< 正在发送指令          */
+	MINIP_XFER_WAIT,         /*!< 指令已发送，等待雷达应答 */
+	MINIP_XFER_READ,         /*!< 正在读取应答          */
+	MINIP_XFER_DONE          /*!< 事务结束，结果见status */
+}MinipXferStateEnum;
+
+/** 
+  * @描述   异步事务描述符，由调用者提供内存，事务结束前不得释放
+  */
+typedef struct
+{
+	uint8_t           addr;         // 从机地址
+	const uint8_t    *cmd_buf;      // 指令地址，可以直接指向flash中的常量指令帧
+	uint8_t           cmd_len;      // 指令长度
+	uint8_t          *ack_buf;      // 应答接收地址，ack_len为0时表示只写不读
+	uint8_t           ack_len;      // 应答长度
+	uint32_t          wait_time;    // 指令发送和应答读取的间隔，单位ms
+	volatile uint8_t  state;        // 事务状态，见MinipXferStateEnum
+	volatile uint8_t  status;       // 事务结果，I2C_OK或详细错误状态
+	uint32_t          tick_start;   // 开始发送指令时的计数值，以下用于性能统计
+	uint32_t          tick_write;   // 指令发送完成时的计数值
+	uint32_t          tick_read;    // 开始读取应答时的计数值
+	uint32_t          tick_done;    // 事务结束时的计数值
+}MinipXferStruct;
+
 typedef struct
 {
 	uint8_t num;
 	uint8_t addr_list[127];
 }MinipDevListStruct;
 
+/** 
+  * @描述   从机地址集合，每个地址占一位，地址n对应bits[n / 32]的第(n % 32)位。
+  *         查询、加入、移除均为常数时间，整个集合只占16字节，可以放在任务栈上。
+  */
 typedef struct
 {
-	uint16_t dist;
-	uint16_t amp;
-	uint32_t tick_ms;
-}MinipDataStruct;
+	uint32_t bits[4];
+}MinipAddrSetStruct;
 
 typedef struct
 {
@@ -63,12 +186,229 @@ typedef struct
 	uint8_t revision;
 }MinipFirmwareVersion;
 
+/** 
+  * @描述   雷达配置缓存，保存最近一次读到或成功写入的配置。valid中对应标志置位的项才有效，
+  *         读取函数优先返回有效的缓存项，不访问总线。
+  */
+typedef struct
+{
+	uint8_t              valid;     // 有效标志，见MINIP_CACHE_xxx
+	uint8_t              en;        // 使能状态
+	uint8_t              amp_th;    // AMP阈值
+	uint16_t             rate;      // 帧率
+	uint16_t             dist_min;  // 距离限制的最小值
+	uint16_t             dist_max;  // 距离限制的最大值
+	MinipFirmwareVersion version;   // 固件版本号
+}MinipCacheStruct;
+
+/** 
+  * @描述   雷达健康记录，每台雷达一条
+  */
+typedef struct
+{
+	uint8_t addr;       // 从机地址
+	uint8_t health;     // 健康状态，见MinipHealthEnum
+	uint8_t fail_cnt;   // 连续失败次数
+	uint8_t backoff;    // 当前退避间隔，单位采集周期
+	uint8_t wait;       // 距离下次轮询还需跳过的周期数
+	uint8_t ack_wait;   // 观测到的最短配置应答时间，单位ms，0表示尚未观测到
+	MinipCacheStruct cache;   // 配置缓存，建立记录时全部无效
+}MinipDevStruct;
+
+/** 
+  * @描述   单个从机地址的累计传输统计，status_cnt[n]为结果是状态n的次数。
+  *         I2C_FRAME_ERROR的次数同时计入I2C_OK，因为这些事务在总线层面是成功的。
+  */
+typedef struct
+{
+	uint8_t  addr;
+	uint32_t status_cnt[MINIP_STATUS_NUM];
+}MinipAddrStatStruct;
+
+/** 
+  * @描述   MINIP总线句柄。每条I2C总线对应一个句柄，句柄内保存该总线的访问函数、设备集合、排除集合和计数，
+  *         不同总线的句柄互不影响，可以在不同任务中并行操作。句柄由用户定义，通过MinipBusInit初始化。
+  */
+typedef struct
+{
+	I2cWriteFuncPtr     i2c_write_func;
+	I2cReadFuncPtr      i2c_read_func;
+	I2cBusResetFuncPtr  i2c_reset_func;
+	DelayMsFuncPtr      delay_ms_func;
+	I2cWriteFuncPtr     i2c_write_it_func;  // 异步写启动函数，为NULL时使用阻塞方式访问总线
+	I2cReadFuncPtr      i2c_read_it_func;   // 异步读启动函数
+	XferNotifyFuncPtr   xfer_notify_func;
+	XferWaitFuncPtr     xfer_wait_func;
+	I2cProbeFuncPtr     i2c_probe_func;     // 地址探测函数，为NULL时扫描使用写一个0xFF字节的方式探测
+	I2cBusStuckFuncPtr  i2c_stuck_func;     // 总线卡死检测函数，为NULL时扫描按旧方式复位总线
+	DevEventFuncPtr     dev_event_func;     // 设备变化通知函数，可以为NULL
+	MinipXferStruct * volatile xfer;        // 正在进行的异步事务
+	MinipAddrSetStruct  dev_set;        // 总线上的MINIP从机地址集合
+	MinipAddrSetStruct  ex_set;         // 需要排除的其他设备的从机地址集合
+	uint8_t             hotplug_cursor; // 增量发现的下一个探测地址
+	uint8_t             hotplug_step;   // 增量发现每次最多探测的地址数，为0时关闭
+	MinipDevStruct      dev[MINIP_MAX_DEV]; // 设备集合中雷达的健康记录
+	uint8_t             dev_num;        // 健康记录数量
+	uint32_t            sync_cycle;     // 同步采集的周期编号
+	uint32_t            xfer_cnt;       // 总线事务总数
+	uint32_t            status_cnt[MINIP_STATUS_NUM];  // 总线上所有事务按结果分类的累计次数
+	MinipAddrStatStruct stat[MINIP_MAX_DEV];   // 按从机地址分类的累计次数，首次访问时建立，不随设备移除而删除
+	uint8_t             stat_num;
+	MinipPerfStruct     perf;           // 事务延时直方图和总线占用率
+	uint8_t             verify_flag;    // 1读取并校验配置指令的应答，0只发送指令
+	uint8_t             adaptive_wait;  // 1按观测到的应答时间等待配置应答，0固定等待MINIP_ACK_WAIT_MS
+	uint8_t             init_flag;
+}MinipBus;
+
+typedef struct
+{
+	uint16_t dist;
+	uint16_t amp;
+	uint32_t tick_ms;
+}MinipDataStruct;
+
+/** 
+  * @描述  同步采集的触发方式枚举
+  */
+typedef enum
+{
+	MINIP_TRIG_BROADCAST = 0,   /*!< 向地址0广播一次触发指令，固件不支持时自动改为逐台触发 */
+	MINIP_TRIG_STAGGER          /*!< 依次向每台雷达发送触发指令                      */
+}MinipTrigModeEnum;
+
+/** 
+  * @描述  同步采集的样本，同一周期内所有雷达的样本具有相同的cycle
+  */
+typedef struct
+{
+	uint32_t        cycle;      // 同步周期编号
+	uint8_t         status;     // 本周期的读取结果，I2C_OK或详细错误状态
+	MinipDataStruct data;
+}MinipSyncSampleStruct;
+
+/** 
+  * @描述  批量配置的配置项枚举，配置项n对应配置缓存的有效标志(1 << n)
+  */
+typedef enum
+{
+	MINIP_CFG_RATE = 0,      /*!< 帧率     */
+	MINIP_CFG_EN,            /*!< 使能状态  */
+	MINIP_CFG_AMP_TH,        /*!< AMP阈值  */
+	MINIP_CFG_DIST_LIMIT,    /*!< 距离限制  */
+	MINIP_CFG_NUM
+}MinipConfigFieldEnum;
+
+/** 
+  * @描述   期望的雷达配置，只有mask中置位的项参与比较和设置
+  */
+typedef struct
+{
+	uint8_t  mask;      // 需要设置的配置项，MINIP_CACHE_RATE/EN/AMP_TH/DIST_LIMIT的组合
+	uint8_t  en;        // 使能状态，0关闭，1使能
+	uint8_t  amp_th;    // AMP阈值，数值为实际AMP阈值的10分之1
+	uint16_t rate;      // 帧率，0为单次触发模式
+	uint16_t dist_min;  // 距离限制的最小值，单位cm
+	uint16_t dist_max;  // 距离限制的最大值，单位cm
+}MinipConfig;
+
+/** 
+  * @描述   单台雷达的批量配置结果。配置项与期望值相同时不发送指令，结果为I2C_OK。
+  */
+typedef struct
+{
+	uint8_t addr;                       // 从机地址
+	uint8_t sent;                       // 实际发送了指令的配置项，见MINIP_CACHE_xxx
+	uint8_t status[MINIP_CFG_NUM];      // 各配置项的结果，I2C_OK或详细错误状态
+	uint8_t save;                       // 保存设置的结果，没有发送任何配置时不保存，结果为I2C_OK
+	MinipCacheStruct cur;               // 没有健康记录的雷达读到的当前配置，代替配置缓存用于比较，valid中置位的项有效
+}MinipConfigResultStruct;
+
+/* 从机地址集合操作 */
+void    MinipAddrSetClear(MinipAddrSetStruct *set);
+uint8_t MinipAddrSetContains(const MinipAddrSetStruct *set, uint8_t addr);
+void    MinipAddrSetInsert(MinipAddrSetStruct *set, uint8_t addr);
+void    MinipAddrSetRemove(MinipAddrSetStruct *set, uint8_t addr);
+uint8_t MinipAddrSetFindFree(const MinipAddrSetStruct *set);
+uint8_t MinipAddrSetToList(const MinipAddrSetStruct *set, MinipDevListStruct *list);
+void    MinipAddrSetInsertRange(MinipAddrSetStruct *set, uint8_t first, uint8_t last);
+
+/* 多总线接口，每个函数的第一个参数为总线句柄 */
+void MinipBusInit(MinipBus *bus, I2cWriteFuncPtr i2c_write, I2cReadFuncPtr i2c_read, I2cBusResetFuncPtr i2c_reset, DelayMsFuncPtr delay_ms);
+void MinipBusAsyncInit(MinipBus *bus, I2cWriteFuncPtr i2c_write_it, I2cReadFuncPtr i2c_read_it, XferNotifyFuncPtr notify, XferWaitFuncPtr wait);
+uint8_t MinipBusXferSubmit(MinipBus *bus, MinipXferStruct *xfer);
+uint8_t MinipBusXferWait(MinipBus *bus, MinipXferStruct *xfer, uint32_t timeout);
+void MinipBusXferCpltHandler(MinipBus *bus, uint8_t status);
+void MinipBusScanInit(MinipBus *bus, I2cProbeFuncPtr probe, I2cBusStuckFuncPtr stuck);
+uint8_t MinipBusI2cScanBus(MinipBus *bus, MinipDevListStruct *list);
+uint8_t MinipBusI2cScanHint(MinipBus *bus, const MinipAddrSetStruct *hint, MinipDevListStruct *list);
+void MinipBusHotplugInit(MinipBus *bus, uint8_t step, DevEventFuncPtr event);
+uint8_t MinipBusHotplugStep(MinipBus *bus, MinipDevListStruct *list);
+uint8_t MinipBusHealthSelect(MinipBus *bus, MinipDevListStruct *poll);
+uint8_t MinipBusHealthFilter(MinipBus *bus, MinipDevListStruct *poll);
+void MinipBusHealthReport(MinipBus *bus, uint8_t addr, uint8_t status);
+uint8_t MinipBusHealthGet(MinipBus *bus, uint8_t addr);
+void MinipBusGetBusStat(MinipBus *bus, uint32_t *status_cnt);
+uint8_t MinipBusGetAddrStat(MinipBus *bus, uint8_t addr, uint32_t *status_cnt);
+void MinipBusClearStat(MinipBus *bus);
+void MinipBusTimingInit(MinipBus *bus, TickFuncPtr tick, uint32_t tick_per_us);
+void MinipBusVerifyInit(MinipBus *bus, uint8_t enable);
+void MinipBusAdaptiveWaitInit(MinipBus *bus, uint8_t enable);
+uint8_t MinipBusAddrDynamicAllocation(MinipBus *bus, uint8_t default_addr, MinipDevListStruct *list);
+void MinipBusAddrExclude(MinipBus *bus, uint8_t num, uint8_t *ex_list);
+void MinipBusCacheInvalidate(MinipBus *bus, uint8_t addr, uint8_t mask);
+
+uint8_t  MinipBusReadData(MinipBus *bus, uint8_t addr, MinipDataStruct *data);
+uint8_t  MinipBusReadDataMany(MinipBus *bus, uint8_t *addr_list, uint8_t n, MinipDataStruct *data, uint8_t *status);
+uint8_t  MinipBusReadDataHealthy(MinipBus *bus, MinipDevListStruct *poll, MinipDataStruct *data, uint8_t *status);
+uint8_t  MinipBusSyncStart(MinipBus *bus, uint8_t *addr_list, uint8_t n);
+uint8_t  MinipBusSyncCapture(MinipBus *bus, uint8_t *addr_list, uint8_t n, uint8_t mode, MinipSyncSampleStruct *sample);
+uint8_t  MinipBusSyncStop(MinipBus *bus, uint8_t *addr_list, uint8_t n, uint16_t rate);
+uint8_t  MinipBusReadVersion(MinipBus *bus, uint8_t addr, MinipFirmwareVersion *verion);
+uint8_t  MinipBusSoftReset(MinipBus *bus, uint8_t addr);
+uint8_t  MinipBusSetSampleRate(MinipBus *bus, uint8_t addr, uint16_t rate);
+uint8_t  MinipBusGetSampleRate(MinipBus *bus, uint8_t addr, uint16_t *rate);
+uint8_t  MinipBusSampleTrig(MinipBus *bus, uint8_t addr);
+uint8_t  MinipBusEnable(MinipBus *bus, uint8_t addr);
+uint8_t  MinipBusDisable(MinipBus *bus, uint8_t addr);
+uint8_t  MinipBusGetStatus(MinipBus *bus, uint8_t addr, uint8_t *status);
+uint8_t  MinipBusSetSlaveAddr(MinipBus *bus, uint8_t addr, uint8_t new_addr);
+uint8_t  MinipBusRestoreDefault(MinipBus *bus, uint8_t addr);
+uint8_t  MinipBusSaveSettings(MinipBus *bus, uint8_t addr);
+uint8_t  MinipBusSetAmpThreshold(MinipBus *bus, uint8_t addr, uint8_t amp_th);
+uint8_t  MinipBusGetAmpThreshold(MinipBus *bus, uint8_t addr, uint8_t *amp_th);
+uint8_t  MinipBusSetDistLimit(MinipBus *bus, uint8_t addr, uint16_t min, uint16_t max);
+uint8_t  MinipBusGetDistLimit(MinipBus *bus, uint8_t addr, uint16_t *min, uint16_t *max);
+uint8_t  MinipBusTimestampSync(MinipBus *bus, uint8_t addr, uint32_t std);
+uint8_t  MinipBusConfigApply(MinipBus *bus, uint8_t *addr_list, uint8_t n, const MinipConfig *cfg, MinipConfigResultStruct *result);
+
+/* 单总线接口，操作默认总线，保持与旧版本兼容 */
+MinipBus *MinipDefaultBus(void);
 void MinipI2cInit(I2cWriteFuncPtr i2c_write, I2cReadFuncPtr i2c_read, I2cBusResetFuncPtr i2c_reset, DelayMsFuncPtr delay_ms);
-MinipDevListStruct MinipI2cScanBus(void);
-MinipDevListStruct MinipAddrDynamicAllocation(uint8_t default_addr);
+void MinipScanInit(I2cProbeFuncPtr probe, I2cBusStuckFuncPtr stuck);
+uint8_t MinipI2cScanBus(MinipDevListStruct *list);
+uint8_t MinipI2cScanHint(const MinipAddrSetStruct *hint, MinipDevListStruct *list);
+void MinipHotplugInit(uint8_t step, DevEventFuncPtr event);
+uint8_t MinipHotplugStep(MinipDevListStruct *list);
+uint8_t MinipHealthSelect(MinipDevListStruct *poll);
+uint8_t MinipHealthFilter(MinipDevListStruct *poll);
+void MinipHealthReport(uint8_t addr, uint8_t status);
+uint8_t MinipHealthGet(uint8_t addr);
+void MinipGetBusStat(uint32_t *status_cnt);
+uint8_t MinipGetAddrStat(uint8_t addr, uint32_t *status_cnt);
+void MinipClearStat(void);
+void MinipTimingInit(TickFuncPtr tick, uint32_t tick_per_us);
+void MinipVerifyInit(uint8_t enable);
+void MinipAdaptiveWaitInit(uint8_t enable);
+uint8_t MinipAddrDynamicAllocation(uint8_t default_addr, MinipDevListStruct *list);
 void MinipAddrExclude(uint8_t num, uint8_t *ex_list);
+void MinipCacheInvalidate(uint8_t addr, uint8_t mask);
 
 uint8_t  MinipReadData(uint8_t addr, MinipDataStruct *data);
+uint8_t  MinipReadDataMany(uint8_t *addr_list, uint8_t n, MinipDataStruct *data, uint8_t *status);
+uint8_t  MinipReadDataHealthy(MinipDevListStruct *poll, MinipDataStruct *data, uint8_t *status);
+uint8_t  MinipSyncStart(uint8_t *addr_list, uint8_t n);
+uint8_t  MinipSyncCapture(uint8_t *addr_list, uint8_t n, uint8_t mode, MinipSyncSampleStruct *sample);
+uint8_t  MinipSyncStop(uint8_t *addr_list, uint8_t n, uint16_t rate);
 uint8_t  MinipReadVersion(uint8_t addr, MinipFirmwareVersion *verion);
 uint8_t  MinipSoftReset(uint8_t addr);
 uint8_t  MinipSetSampleRate(uint8_t addr, uint16_t rate);
@@ -85,6 +425,7 @@ uint8_t  MinipGetAmpThreshold(uint8_t addr, uint8_t *amp_th);
 uint8_t  MinipSetDistLimit(uint8_t addr, uint16_t min, uint16_t max);
 uint8_t  MinipGetDistLimit(uint8_t addr, uint16_t *min, uint16_t *max);
 uint8_t  MinipTimestampSync(uint8_t addr, uint32_t std);
+uint8_t  MinipConfigApply(uint8_t *addr_list, uint8_t n, const MinipConfig *cfg, MinipConfigResultStruct *result);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,242 @@
+/**
+  ******************************************************************************
+  * @文件    tfminip_perf.c
+  * @描述    I2C事务性能统计：按从机地址和事务阶段记录对数分桶的延时直方图，
+  *          以及总线复位用时和总线占用率。不依赖任何硬件，可以在PC上编译使用。
+  ******************************************************************************
+  */
+#include "tfminip_perf.h"
+#include "string.h"
+
+#ifndef NULL
+	#define NULL ((void*)0)
+#endif
+
+/**
+  * @描述   计算延时所在的直方图桶
+  * @参数   us：延时，单位us
+  * @返回值 桶序号，floor(log2(us))，不超过MINIP_PERF_BUCKET_NUM - 1
+  */
+static uint8_t log2_bucket(uint32_t us)
+{
+	uint8_t b = 0;
+	while((us > 1) && (b < MINIP_PERF_BUCKET_NUM - 1))
+	{
+		us >>= 1;
+		b++;
+	}
+	return b;
+}
+
+/**
+  * @描述   初始化性能统计
+  * @参数   perf：性能统计
+  * @参数   tick：计时函数，为NULL时不统计
+  * @参数   tick_per_us：每微秒的计数值，例如72MHz主频下的DWT->CYCCNT为72
+  * @返回值 无
+  */
+void MinipPerfInit(MinipPerfStruct *perf, TickFuncPtr tick, uint32_t tick_per_us)
+{
+	memset(perf, 0, sizeof(MinipPerfStruct));
+	perf->tick_func   = tick;
+	perf->tick_per_us = (tick_per_us > 0) ? tick_per_us : 1;
+	perf->window_tick = MinipPerfNow(perf);
+}
+
+/**
+  * @描述   读取当前计数值
+  * @参数   perf：性能统计
+  * @返回值 当前计数值，未注册计时函数时返回0
+  */
+uint32_t MinipPerfNow(MinipPerfStruct *perf)
+{
+	return (NULL != perf->tick_func) ? perf->tick_func() : 0;
+}
+
+/**
+  * @描述   计算两个计数值之间的时间，计数溢出一次时结果仍然正确
+  * @参数   perf：性能统计
+  * @参数   start：起始计数值
+  * @参数   end：结束计数值
+  * @返回值 时间，单位us
+  */
+uint32_t MinipPerfElapsedUs(MinipPerfStruct *perf, uint32_t start, uint32_t end)
+{
+	return (end - start) / perf->tick_per_us;
+}
+
+/**
+  * @描述   记录一个事务阶段的用时。发送和读取阶段同时计入总线占用时间，等待阶段总线空闲，不计入。
+  * @参数   perf：性能统计
+  * @参数   addr：从机地址
+  * @参数   phase：事务阶段，见MinipPhaseEnum
+  * @参数   us：用时，单位us
+  * @返回值 无
+  */
+void MinipPerfRecord(MinipPerfStruct *perf, uint8_t addr, uint8_t phase, uint32_t us)
+{
+	uint8_t k;
+
+	if((NULL == perf->tick_func) || (phase >= MINIP_PHASE_NUM))
+	{
+		return;
+	}
+	if(MINIP_PHASE_WAIT != phase)
+	{
+		perf->busy_us += us;
+	}
+
+	for(k = 0; k < perf->dev_num; k++)
+	{
+		if(addr == perf->dev[k].addr)
+		{
+			break;
+		}
+	}
+	if(k == perf->dev_num)
+	{
+		if(perf->dev_num >= MINIP_PERF_MAX_DEV)
+		{
+			return;
+		}
+		memset(&perf->dev[k], 0, sizeof(MinipPerfDevStruct));
+		perf->dev[k].addr = addr;
+		perf->dev_num++;
+	}
+
+	MinipPerfDevStruct *dev = &perf->dev[k];
+	uint16_t *cnt = &dev->hist[phase][log2_bucket(us)];
+	if(*cnt < 0xFFFF)
+	{
+		(*cnt)++;
+	}
+	if(us > dev->max_us[phase])
+	{
+		dev->max_us[phase] = us;
+	}
+}
+
+/**
+  * @描述   记录一次总线复位的用时，复位期间总线不可用，计入总线占用时间
+  * @参数   perf：性能统计
+  * @参数   us：用时，单位us
+  * @返回值 无
+  */
+void MinipPerfRecordReset(MinipPerfStruct *perf, uint32_t us)
+{
+	if(NULL == perf->tick_func)
+	{
+		return;
+	}
+	perf->reset_cnt++;
+	perf->reset_us += us;
+	perf->busy_us  += us;
+}
+
+/**
+  * @描述   把上次累加之后经过的时间计入当前窗口，不足1us的计数值留到下次
+  * @参数   perf：性能统计
+  * @返回值 无
+  */
+static void window_accumulate(MinipPerfStruct *perf)
+{
+	uint32_t us = MinipPerfElapsedUs(perf, perf->window_tick, MinipPerfNow(perf));
+
+	perf->window_tick += us * perf->tick_per_us;
+	perf->window_us   += us;
+}
+
+/**
+  * @描述   累加当前窗口的时间，窗口达到MINIP_PERF_WINDOW_US时结束窗口。须在任务中周期调用，
+  *         间隔小于计时函数计数值溢出的周期，例如每个调度周期调用一次。
+  * @参数   perf：性能统计
+  * @返回值 无
+  */
+void MinipPerfPoll(MinipPerfStruct *perf)
+{
+	if(NULL == perf->tick_func)
+	{
+		return;
+	}
+	window_accumulate(perf);
+	if(perf->window_us >= MINIP_PERF_WINDOW_US)
+	{
+		MinipPerfWindow(perf);
+	}
+}
+
+/**
+  * @描述   结束当前统计窗口并开始新的窗口，上一个窗口的占用率由MinipPerfBusyPermille读取
+  * @参数   perf：性能统计
+  * @返回值 无
+  */
+void MinipPerfWindow(MinipPerfStruct *perf)
+{
+	window_accumulate(perf);
+	perf->last_window_us = perf->window_us;
+	perf->last_busy_us   = perf->busy_us;
+	perf->window_us      = 0;
+	perf->busy_us        = 0;
+}
+
+/**
+  * @描述   读取上一个统计窗口的总线占用率
+  * @参数   perf：性能统计
+  * @返回值 占用率，单位千分之一
+  */
+uint16_t MinipPerfBusyPermille(MinipPerfStruct *perf)
+{
+	if(0 == perf->last_window_us)
+	{
+		return 0;
+	}
+	uint64_t permille = (uint64_t)perf->last_busy_us * 1000 / perf->last_window_us;
+	return (permille > 1000) ? 1000 : (uint16_t)permille;
+}
+
+/**
+  * @描述   清空直方图和复位统计，计时函数保持不变，并开始新的统计窗口
+  * @参数   perf：性能统计
+  * @返回值 无
+  */
+void MinipPerfClear(MinipPerfStruct *perf)
+{
+	MinipPerfInit(perf, perf->tick_func, perf->tick_per_us);
+}
+
+/**
+  * @描述   输出上一个完整统计窗口的总线占用率、复位统计和每个从机地址的延时直方图。
+  *         直方图每行为一个阶段，依次为各桶的计数，第b个桶的下限为2^b us。
+  * @参数   perf：性能统计
+  * @参数   print：打印函数，在目标板上可以直接使用printf
+  * @返回值 无
+  */
+void MinipPerfDump(MinipPerfStruct *perf, PerfPrintFuncPtr print)
+{
+	static const char *phase_name[MINIP_PHASE_NUM] = {"write", "wait ", "read "};
+	uint16_t busy;
+
+	if(NULL == perf->tick_func)
+	{
+		print("perf disabled\n");
+		return;
+	}
+
+	MinipPerfPoll(perf);
+	busy = MinipPerfBusyPermille(perf);
+	print("window=%luus busy=%u.%u%% reset=%lu reset_time=%luus\n", (unsigned long)perf->last_window_us,
+	      busy / 10, busy % 10, (unsigned long)perf->reset_cnt, (unsigned long)perf->reset_us);
+	for(uint8_t k = 0; k < perf->dev_num; k++)
+	{
+		MinipPerfDevStruct *dev = &perf->dev[k];
+		for(uint8_t p = 0; p < MINIP_PHASE_NUM; p++)
+		{
+			print("0x%02x %s max=%6luus |", dev->addr, phase_name[p], (unsigned long)dev->max_us[p]);
+			for(uint8_t b = 0; b < MINIP_PERF_BUCKET_NUM; b++)
+			{
+				print(" %u", dev->hist[p][b]);
+			}
+			print("\n");
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef _TFMINIP_PERF_H
+#define _TFMINIP_PERF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#ifndef MINIP_PERF_MAX_DEV
+#define MINIP_PERF_MAX_DEV      (16)    // 记录延时直方图的最大从机地址数量
+#endif
+#define MINIP_PERF_BUCKET_NUM   (16)    // 直方图桶数，第b个桶记录[2^b, 2^(b+1))us的延时，最后一个桶包含所有更长的延时
+#ifndef MINIP_PERF_WINDOW_US
+#define MINIP_PERF_WINDOW_US    (1000000)   // 总线占用率的统计窗口长度
+#endif
+
+/**
+  * @描述   计时函数，返回一个自由运行的32位计数值，例如Cortex-M的DWT->CYCCNT，溢出后从0继续计数
+  * @参数   无
+  * @返回值 当前计数值
+  */
+typedef uint32_t (*TickFuncPtr)(void);
+
+/**
+  * @描述   打印函数，与printf的形式相同，用于输出统计结果
+  */
+typedef int (*PerfPrintFuncPtr)(const char *, ...);
+
+/**
+  * @描述  事务阶段枚举
+  */
+typedef enum
+{
+	MINIP_PHASE_WRITE = 0,   /*!< 发送指令           */
+	MINIP_PHASE_WAIT,        /*!< 指令发送后等待雷达应答 */
+	MINIP_PHASE_READ,        /*!< 读取应答           */
+	MINIP_PHASE_NUM
+}MinipPhaseEnum;
+
+/**
+  * @描述   单个从机地址的各阶段延时直方图，计数达到0xFFFF后不再增加
+  */
+typedef struct
+{
+	uint8_t  addr;
+	uint16_t hist[MINIP_PHASE_NUM][MINIP_PERF_BUCKET_NUM];
+	uint32_t max_us[MINIP_PHASE_NUM];
+}MinipPerfDevStruct;
+
+/**
+  * @描述   一条总线的性能统计。只在任务中更新，不在中断中修改。
+  *         统计窗口的时间由MinipPerfPoll逐次累加，32位计数值溢出(72MHz时约59.6s)不影响窗口长度，
+  *         两次调用的间隔须小于计数值溢出的周期。
+  */
+typedef struct
+{
+	TickFuncPtr        tick_func;       // 计时函数，为NULL时不统计
+	uint32_t           tick_per_us;     // 每微秒的计数值
+	MinipPerfDevStruct dev[MINIP_PERF_MAX_DEV];
+	uint8_t            dev_num;
+	uint32_t           reset_cnt;       // 总线复位次数
+	uint32_t           reset_us;        // 总线复位累计用时
+	uint32_t           window_tick;     // 上次累加窗口时间时的计数值
+	uint32_t           window_us;       // 当前窗口已经过的时间
+	uint32_t           busy_us;         // 当前窗口内总线传输的累计用时
+	uint32_t           last_window_us;  // 上一个窗口的长度
+	uint32_t           last_busy_us;    // 上一个窗口内总线传输的累计用时
+}MinipPerfStruct;
+
+void     MinipPerfInit(MinipPerfStruct *perf, TickFuncPtr tick, uint32_t tick_per_us);
+uint32_t MinipPerfNow(MinipPerfStruct *perf);
+uint32_t MinipPerfElapsedUs(MinipPerfStruct *perf, uint32_t start, uint32_t end);
+void     MinipPerfRecord(MinipPerfStruct *perf, uint8_t addr, uint8_t phase, uint32_t us);
+void     MinipPerfRecordReset(MinipPerfStruct *perf, uint32_t us);
+void     MinipPerfPoll(MinipPerfStruct *perf);
+void     MinipPerfWindow(MinipPerfStruct *perf);
+uint16_t MinipPerfBusyPermille(MinipPerfStruct *perf);
+void     MinipPerfClear(MinipPerfStruct *perf);
+void     MinipPerfDump(MinipPerfStruct *perf, PerfPrintFuncPtr print);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
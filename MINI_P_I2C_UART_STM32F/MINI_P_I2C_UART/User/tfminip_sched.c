@@ -0,0 +1,336 @@
+/**
+  ******************************************************************************
+  * @文件    tfminip_sched.c
+  * @描述    I2C总线读取调度：每台雷达有各自的目标帧率和优先级，加入时做总线占用的准入检查，
+  *          每个调度间隔按优先级和速率单调原则选出到期的雷达。不依赖任何硬件，可以在PC上编译使用。
+  ******************************************************************************
+  */
+#include "tfminip_sched.h"
+#include "string.h"
+
+#ifndef NULL
+	#define NULL ((void*)0)
+#endif
+
+/**
+  * @描述   判断时间a是否不早于时间b，计数溢出一次时结果仍然正确
+  * @参数   a、b：时间，单位us
+  * @返回值 1 a不早于b，0 a早于b
+  */
+static uint8_t time_after_eq(uint32_t a, uint32_t b)
+{
+	return ((int32_t)(a - b) >= 0) ? 1 : 0;
+}
+
+/**
+  * @描述   比较两台雷达的调度次序。已推迟超过一个自身周期的雷达排在最前，总线预算紧张时低优先级的雷达也不会一直得不到读取。
+  * @参数   a、b：调度记录
+  * @参数   now_us：当前时间
+  * @返回值 1 a应排在b之前，0 否则
+  */
+static uint8_t entry_before(const MinipSchedEntryStruct *a, const MinipSchedEntryStruct *b, uint32_t now_us)
+{
+	uint8_t late_a = time_after_eq(now_us, a->next_us + a->period_us);
+	uint8_t late_b = time_after_eq(now_us, b->next_us + b->period_us);
+
+	if(late_a != late_b)
+	{
+		return late_a;
+	}
+	if(a->prio != b->prio)
+	{
+		return (a->prio > b->prio) ? 1 : 0;
+	}
+	return (a->period_us < b->period_us) ? 1 : 0;
+}
+
+/**
+  * @描述   按上次调度以来经过的时间积累总线预算，最多积累MINIP_SCHED_BURST次读取的用时
+  * @参数   sched：调度器
+  * @参数   now_us：当前时间
+  * @返回值 无
+  */
+static void credit_accrue(MinipSchedStruct *sched, uint32_t now_us)
+{
+	uint32_t cap = sched->cost_us * MINIP_SCHED_BURST;
+
+	if(!sched->started)
+	{
+		sched->started   = 1;
+		sched->credit_us = sched->cost_us;  // 第一次调度可以读取一台雷达
+	}
+	else
+	{
+		uint32_t elapsed = now_us - sched->last_us;
+		elapsed = (elapsed > cap) ? cap : elapsed;
+		sched->credit_us += (uint32_t)((uint64_t)elapsed * sched->budget / 1000);
+	}
+	if(sched->credit_us > cap)
+	{
+		sched->credit_us = cap;
+	}
+	sched->last_us = now_us;
+}
+
+/**
+  * @描述   初始化调度器
+  * @参数   sched：调度器
+  * @参数   tick_us：调度间隔，即调用MinipSchedSelect的间隔
+  * @参数   cost_us：读取一台雷达的总线用时，可以参考MinipPerfDump输出的写入和读取阶段用时
+  * @参数   budget：总线预算，单位千分之一，为0或超过1000时按1000计算
+  * @返回值 无
+  */
+void MinipSchedInit(MinipSchedStruct *sched, uint32_t tick_us, uint32_t cost_us, uint16_t budget)
+{
+	memset(sched, 0, sizeof(MinipSchedStruct));
+	sched->tick_us = (tick_us > 0) ? tick_us : 1000;
+	sched->cost_us = (cost_us > 0) ? cost_us : 1;
+	sched->budget  = ((0 == budget) || (budget > 1000)) ? 1000 : budget;
+}
+
+/**
+  * @描述   查找雷达的调度记录
+  * @参数   sched：调度器
+  * @参数   addr：从机地址
+  * @返回值 调度记录，没有时返回NULL
+  */
+MinipSchedEntryStruct *MinipSchedGet(MinipSchedStruct *sched, uint8_t addr)
+{
+	for(uint8_t k = 0; k < sched->num; k++)
+	{
+		if(addr == sched->entry[k].addr)
+		{
+			return &sched->entry[k];
+		}
+	}
+	return NULL;
+}
+
+/**
+  * @描述   加入一台雷达，已在调度表中时修改其帧率和优先级。加入前检查准入条件：所有雷达每秒占用总线的时间不超过预算，
+  *         且帧率不超过每个调度间隔读取一次。不满足时以满足条件的最高帧率加入，预算已经用完时以1Hz加入，
+  *         此时超出的部分由MinipSchedSelect推迟，雷达仍会被读取。调度表已满或参数错误时调度表保持不变。
+  *         总线事务不能被抢占，所以不使用速率单调调度的利用率上界，而是按总线预算检查。
+  * @参数   sched：调度器
+  * @参数   addr：从机地址
+  * @参数   rate：目标读取帧率，单位Hz，范围1-1000
+  * @参数   prio：优先级，数值大的优先，一般为0，按帧率排序
+  * @参数   now_us：当前时间，雷达从此刻起到期
+  * @返回值 MINIP_SCHED_OK，MINIP_SCHED_REDUCED以降低的帧率加入，实际帧率见调度记录的rate，或失败原因
+  */
+uint8_t MinipSchedAdd(MinipSchedStruct *sched, uint8_t addr, uint16_t rate, uint8_t prio, uint32_t now_us)
+{
+	MinipSchedEntryStruct *entry = MinipSchedGet(sched, addr);
+	uint32_t old_load = (NULL != entry) ? (uint32_t)entry->rate * sched->cost_us : 0;
+	uint32_t others = sched->load - old_load;
+	uint32_t limit  = (uint32_t)sched->budget * 1000;
+	uint8_t  ret = MINIP_SCHED_OK;
+
+	if((0 == rate) || (rate > 1000))
+	{
+		return MINIP_SCHED_PARA_ERROR;
+	}
+	if((uint32_t)rate * sched->tick_us > 1000000)
+	{
+		rate = 1000000 / sched->tick_us;
+		ret  = MINIP_SCHED_REDUCED;
+	}
+	if(others + (uint32_t)rate * sched->cost_us > limit)
+	{
+		uint32_t fit = (limit > others) ? (limit - others) / sched->cost_us : 0;
+		rate = (fit > 0) ? (uint16_t)fit : 1;
+		ret  = MINIP_SCHED_REDUCED;
+	}
+	if(NULL == entry)
+	{
+		if(sched->num >= MINIP_SCHED_MAX_DEV)
+		{
+			return MINIP_SCHED_FULL;
+		}
+		entry = &sched->entry[sched->num++];
+		memset(entry, 0, sizeof(MinipSchedEntryStruct));
+		entry->addr = addr;
+	}
+
+	sched->load      = others + (uint32_t)rate * sched->cost_us;
+	entry->prio      = prio;
+	entry->rate      = rate;
+	entry->period_us = 1000000 / rate;
+	entry->next_us   = now_us;
+	entry->locked    = 0;  // 帧率改变后重新锁定
+	entry->frame_us  = entry->period_us;
+	return ret;
+}
+
+/**
+  * @描述   移除一台雷达，其余记录保持原有顺序
+  * @参数   sched：调度器
+  * @参数   addr：从机地址
+  * @返回值 无
+  */
+void MinipSchedRemove(MinipSchedStruct *sched, uint8_t addr)
+{
+	MinipSchedEntryStruct *entry = MinipSchedGet(sched, addr);
+	if(NULL == entry)
+	{
+		return;
+	}
+	uint8_t k = entry - sched->entry;
+	sched->load -= (uint32_t)entry->rate * sched->cost_us;
+	sched->num--;
+	memmove(&sched->entry[k], &sched->entry[k + 1], (sched->num - k) * sizeof(MinipSchedEntryStruct));
+}
+
+/**
+  * @描述   选出本次调度需要读取的雷达。先按经过的时间积累总线预算，到期的雷达按优先级排序，依次放入列表，
+  *         直到剩余的预算不够读取一台雷达，未用完的预算留到之后的调度。
+  *         被选中的雷达下次到期时间推后一个周期，推迟超过一个周期时放弃错过的读取，
+  *         从当前时间重新计算，不会为了追赶进度而连续读取。
+  * @参数   sched：调度器
+  * @参数   now_us：当前时间
+  * @参数   addr_list：选中的雷达从机地址，按优先级从高到低排列，长度不小于MINIP_SCHED_MAX_DEV
+  * @返回值 选中的雷达数量
+  */
+uint8_t MinipSchedSelect(MinipSchedStruct *sched, uint32_t now_us, uint8_t *addr_list)
+{
+	MinipSchedEntryStruct *due[MINIP_SCHED_MAX_DEV];
+	uint8_t  due_num = 0;
+	uint8_t  n = 0;
+
+	credit_accrue(sched, now_us);
+
+	// 按优先级插入排序，雷达数量很少
+	for(uint8_t k = 0; k < sched->num; k++)
+	{
+		MinipSchedEntryStruct *entry = &sched->entry[k];
+		uint8_t j;
+
+		if(!time_after_eq(now_us, entry->next_us))
+		{
+			continue;
+		}
+		for(j = due_num; (j > 0) && entry_before(entry, due[j - 1], now_us); j--)
+		{
+			due[j] = due[j - 1];
+		}
+		due[j] = entry;
+		due_num++;
+	}
+
+	for(uint8_t k = 0; k < due_num; k++)
+	{
+		MinipSchedEntryStruct *entry = due[k];
+		if(sched->credit_us < sched->cost_us)
+		{
+			entry->defer_cnt++;
+			continue;
+		}
+		sched->credit_us -= sched->cost_us;
+		addr_list[n++] = entry->addr;
+
+		entry->next_us += entry->period_us;
+		if(time_after_eq(now_us, entry->next_us))
+		{
+			entry->skip_cnt += (now_us - entry->next_us) / entry->period_us + 1;
+			entry->next_us   = now_us + entry->period_us;
+		}
+	}
+	return n;
+}
+
+/**
+  * @描述   计算本地时间t之后(不含t)第一个出帧时刻与base相隔的帧数，至少为1
+  * @参数   base：某一帧可以读到的本地时间
+  * @参数   t：本地时间
+  * @参数   frame_us：出帧周期
+  * @返回值 帧数
+  */
+static uint32_t frames_after(uint32_t base, uint32_t t, uint32_t frame_us)
+{
+	int32_t d = (int32_t)(t - base);
+	return (d < 0) ? 1 : (uint32_t)d / frame_us + 1;
+}
+
+/**
+  * @描述   用一次成功读取的结果锁定雷达的出帧相位，并把下次读取安排在雷达下一帧刚好可以读到之后。
+  *         帧周期由相邻两次新数据的时间戳之差估计；相位偏移取观察到的最小值，并且每次新数据后提前一点试探，
+  *         读到重复数据时说明估计偏早，把偏移推后一个调度间隔。锁定初期每次提前1/4帧，尽快找到出帧时刻，
+  *         第一次读到重复数据后改为每次提前1/4096帧，只跟踪两边时钟的漂移，很少产生重复读取。
+  *         雷达的出帧周期应与读取周期相同，即雷达帧率与调度帧率一致。
+  *         调用前须已对这台雷达调用过MinipSchedSelect，now_us与本次选出时使用的时间相同。
+  * @参数   sched：调度器
+  * @参数   addr：从机地址
+  * @参数   tick_ms：本次读到的雷达时间戳，即MinipDataStruct的tick_ms
+  * @参数   now_us：本次读取的时间
+  * @返回值 1时间戳与上次相同，本次数据是重复的；0新数据或雷达不在调度表中
+  */
+uint8_t MinipSchedUpdate(MinipSchedStruct *sched, uint8_t addr, uint32_t tick_ms, uint32_t now_us)
+{
+	MinipSchedEntryStruct *entry = MinipSchedGet(sched, addr);
+	uint32_t obs = now_us - tick_ms * 1000;
+	uint32_t base, k;
+
+	if(NULL == entry)
+	{
+		return 0;
+	}
+	if(!entry->locked)
+	{
+		entry->locked    = 1;
+		entry->last_tick = tick_ms;
+		entry->offset_us = obs;
+		return 0;
+	}
+
+	if(tick_ms == entry->last_tick)
+	{
+		// 下一帧在now_us时还不能读到，而调度器最早在下一个调度间隔才能再次读取，偏移推后到那时
+		uint32_t low = obs - entry->frame_us + sched->tick_us;
+		if((int32_t)(low - entry->offset_us) > 0)
+		{
+			entry->offset_us = low;
+		}
+		entry->stale_cnt++;
+		entry->locked = 2;
+		base = tick_ms * 1000 + entry->offset_us;
+		entry->next_us = base + frames_after(base, now_us, entry->frame_us) * entry->frame_us;
+		return 1;
+	}
+
+	// 帧周期：时间戳之差可能包含多帧，按当前估计折算为一帧后平滑
+	uint32_t d_us = (tick_ms - entry->last_tick) * 1000;
+	uint32_t n = (d_us + entry->frame_us / 2) / entry->frame_us;
+	int32_t  err = (int32_t)(d_us / ((n > 0) ? n : 1)) - (int32_t)entry->frame_us;
+	entry->frame_us += err / 8;
+	if(0 == entry->frame_us)
+	{
+		entry->frame_us = 1;
+	}
+	entry->last_tick = tick_ms;
+
+	// 相位：观察值更早时直接采用，否则提前一点，试探出帧时刻是否已经提前
+	if((int32_t)(obs - entry->offset_us) < 0)
+	{
+		entry->offset_us = obs;
+	}
+	else
+	{
+		entry->offset_us -= ((1 == entry->locked) ? (entry->frame_us >> 2) : (entry->frame_us >> 12)) + 1;
+	}
+
+	// 在MinipSchedSelect给出的下次到期时间附近，选择最近的出帧时刻
+	base = tick_ms * 1000 + entry->offset_us;
+	k = frames_after(base, entry->next_us - entry->frame_us / 2, entry->frame_us);
+	entry->next_us = base + k * entry->frame_us;
+	return 0;
+}
+
+/**
+  * @描述   读取已接纳的雷达占用总线的比例，有雷达以1Hz超出预算加入时可能大于budget
+  * @参数   sched：调度器
+  * @返回值 占用率，单位千分之一
+  */
+uint16_t MinipSchedLoadPermille(MinipSchedStruct *sched)
+{
+	return (uint16_t)(sched->load / 1000);
+}
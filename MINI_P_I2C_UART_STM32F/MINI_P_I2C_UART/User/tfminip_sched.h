@@ -0,0 +1,72 @@
+#ifndef _TFMINIP_SCHED_H
+#define _TFMINIP_SCHED_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#ifndef MINIP_SCHED_MAX_DEV
+#define MINIP_SCHED_MAX_DEV     (16)    // 参与调度的最大雷达数量
+#endif
+#ifndef MINIP_SCHED_BURST
+#define MINIP_SCHED_BURST       (8)     // 总线预算最多积累的读取次数，即一次调度最多批量读取的雷达数量
+#endif
+
+#define MINIP_SCHED_OK          (0)
+#define MINIP_SCHED_FULL        (1)     // 调度表已满
+#define MINIP_SCHED_REDUCED     (2)     // 总线预算不足，已以降低的帧率加入
+#define MINIP_SCHED_PARA_ERROR  (3)     // 参数错误
+
+/**
+  * @描述   单台雷达的调度参数和状态
+  */
+typedef struct
+{
+	uint8_t  addr;          // 从机地址
+	uint8_t  prio;          // 优先级，数值大的优先；优先级相同时帧率高的优先(速率单调)
+	uint16_t rate;          // 目标读取帧率，单位Hz
+	uint32_t period_us;     // 读取周期
+	uint32_t next_us;       // 下次到期时间
+	uint32_t defer_cnt;     // 到期但因本次调度的总线预算不足而推迟的次数
+	uint32_t skip_cnt;      // 推迟超过一个周期而放弃的读取次数
+	// 以下为帧相位锁定的状态，由MinipSchedUpdate根据雷达返回的tick_ms更新
+	uint8_t  locked;        // 0未锁定，1已得到第一帧、正在粗调相位，2已找到出帧时刻、跟踪漂移
+	uint32_t last_tick;     // 最近一次新数据的雷达时间戳，单位ms
+	uint32_t frame_us;      // 估计的雷达出帧周期
+	uint32_t offset_us;     // 雷达时间戳换算为本地时间的偏移：时间戳为t的帧最早在t*1000+offset_us可以读到
+	uint32_t stale_cnt;     // 时间戳未变化的重复读取次数
+}MinipSchedEntryStruct;
+
+/**
+  * @描述   一条总线的读取调度器。每个调度间隔调用一次MinipSchedSelect，按优先级选出到期的雷达，
+  *         选出的雷达的读取用时之和不超过已积累的总线预算，其余到期的雷达推迟到下一次调度。
+  *         预算按经过的时间乘以budget积累，未用完的部分留给之后的调度(令牌桶)，最多积累MINIP_SCHED_BURST次读取，
+  *         读取用时大于单个调度间隔的预算时，长期平均的读取次数仍能达到预算。
+  */
+typedef struct
+{
+	MinipSchedEntryStruct entry[MINIP_SCHED_MAX_DEV];
+	uint8_t  num;
+	uint32_t tick_us;       // 调度间隔
+	uint32_t cost_us;       // 读取一台雷达的总线用时
+	uint16_t budget;        // 总线预算，单位千分之一，读取占用总线的时间不超过该比例
+	uint32_t load;          // 已接纳的雷达每秒占用总线的时间，单位us
+	uint32_t credit_us;     // 已积累、还未使用的总线预算
+	uint32_t last_us;       // 上次调度的时间
+	uint8_t  started;       // 已调度过，last_us有效
+}MinipSchedStruct;
+
+void     MinipSchedInit(MinipSchedStruct *sched, uint32_t tick_us, uint32_t cost_us, uint16_t budget);
+uint8_t  MinipSchedAdd(MinipSchedStruct *sched, uint8_t addr, uint16_t rate, uint8_t prio, uint32_t now_us);
+void     MinipSchedRemove(MinipSchedStruct *sched, uint8_t addr);
+MinipSchedEntryStruct *MinipSchedGet(MinipSchedStruct *sched, uint8_t addr);
+uint8_t  MinipSchedSelect(MinipSchedStruct *sched, uint32_t now_us, uint8_t *addr_list);
+uint8_t  MinipSchedUpdate(MinipSchedStruct *sched, uint8_t addr, uint32_t tick_ms, uint32_t now_us);
+uint16_t MinipSchedLoadPermille(MinipSchedStruct *sched);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
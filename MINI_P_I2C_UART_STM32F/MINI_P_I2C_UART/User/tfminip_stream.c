@@ -0,0 +1,272 @@
+/**
+  ******************************************************************************
+  * @文件    tfminip_stream.c
+  * @描述    测距结果的二进制上传：把一个周期内多台雷达的样本打包为frame格式的数据帧，
+  *          代替逐行打印的文本输出，可选按雷达做差分和varint压缩。不依赖任何硬件，可以在PC上编译使用。
+  ******************************************************************************
+  */
+#include "tfminip_stream.h"
+#include "string.h"
+
+/**
+  * @描述   写入小端的多字节数据
+  * @参数   p：写入位置
+  * @参数   val：数据
+  * @参数   n：字节数
+  * @返回值 无
+  */
+static void put_le(uint8_t *p, uint32_t val, uint8_t n)
+{
+	for(uint8_t k = 0; k < n; k++)
+	{
+		p[k] = (uint8_t)(val >> (8 * k));
+	}
+}
+
+/**
+  * @描述   zigzag变换，绝对值小的有符号数变换为小的无符号数
+  * @参数   val：有符号数
+  * @返回值 变换结果
+  */
+static uint32_t zigzag(int32_t val)
+{
+	return ((uint32_t)val << 1) ^ (uint32_t)(val >> 31);
+}
+
+/**
+  * @描述   写入varint
+  * @参数   p：写入位置，最多写入5个字节
+  * @参数   zz：无符号数
+  * @返回值 写入的字节数
+  */
+static uint8_t put_varint(uint8_t *p, uint32_t zz)
+{
+	uint8_t n = 0;
+
+	while(zz >= 0x80)
+	{
+		p[n++] = (uint8_t)(zz | 0x80);
+		zz >>= 7;
+	}
+	p[n++] = (uint8_t)zz;
+	return n;
+}
+
+/**
+  * @描述   查找雷达的差分基准
+  * @参数   stream：打包状态
+  * @参数   addr：从机地址
+  * @返回值 基准，没有时返回NULL
+  */
+static MinipStreamDevStruct *dev_find(MinipStreamStruct *stream, uint8_t addr)
+{
+	for(uint8_t k = 0; k < stream->dev_num; k++)
+	{
+		if(addr == stream->dev[k].addr)
+		{
+			return &stream->dev[k];
+		}
+	}
+	return NULL;
+}
+
+/**
+  * @描述   编码一个样本。差分压缩时以该雷达的基准计算差分样本，没有基准或差分样本不比完整样本短时使用完整样本，
+  *         并更新基准；没有基准且还有空位时为该雷达建立基准。
+  * @参数   stream：打包状态
+  * @参数   addr：从机地址
+  * @参数   data：测距结果
+  * @参数   p：写入位置，长度不小于MINIP_STREAM_SAMPLE_LEN + 3
+  * @返回值 样本的字节数
+  */
+static uint8_t sample_encode(MinipStreamStruct *stream, uint8_t addr, const MinipDataStruct *data, uint8_t *p)
+{
+	MinipStreamDevStruct *dev = NULL;
+	uint8_t n = 0;
+
+	if(stream->delta)
+	{
+		dev = dev_find(stream, addr);
+		if((NULL == dev) && (stream->dev_num < MINIP_STREAM_MAX_DEV))
+		{
+			dev = &stream->dev[stream->dev_num++];
+			dev->addr  = addr;
+			dev->dtick = 0;
+		}
+		else if(NULL != dev)
+		{
+			uint32_t dtick = data->tick_ms - dev->tick_ms;
+			uint32_t zz_dist = zigzag((int32_t)data->dist - (int32_t)dev->dist);
+			uint32_t zz_amp  = zigzag((int32_t)data->amp - (int32_t)dev->amp);
+			uint32_t zz_tick = zigzag((int32_t)(dtick - dev->dtick));
+			uint8_t  flag = ((0 != zz_amp) ? MINIP_STREAM_AMP_FLAG : 0) | ((0 != zz_tick) ? MINIP_STREAM_TICK_FLAG : 0);
+
+			p[0] = addr;
+			n = 1;
+			n += put_varint(&p[n], (zz_dist << 2) | flag);
+			if(0 != zz_amp)
+			{
+				n += put_varint(&p[n], zz_amp);
+			}
+			if(0 != zz_tick)
+			{
+				n += put_varint(&p[n], zz_tick);
+			}
+			dev->dtick = dtick;
+		}
+	}
+
+	if((0 == n) || (n >= MINIP_STREAM_SAMPLE_LEN))
+	{
+		p[0] = stream->delta ? (addr | MINIP_STREAM_RAW_FLAG) : addr;
+		put_le(&p[1], data->dist, 2);
+		put_le(&p[3], data->amp, 2);
+		put_le(&p[5], data->tick_ms, 4);
+		n = MINIP_STREAM_SAMPLE_LEN;
+		if(NULL != dev)
+		{
+			dev->dtick = 0;
+		}
+	}
+	if(NULL != dev)
+	{
+		dev->dist    = data->dist;
+		dev->amp     = data->amp;
+		dev->tick_ms = data->tick_ms;
+	}
+	return n;
+}
+
+/**
+  * @描述   补全帧长、帧序号和校验和后发送当前帧，没有样本时不发送
+  * @参数   stream：打包状态
+  * @参数   last：1为本周期的最后一帧
+  * @返回值 无
+  */
+static void frame_flush(MinipStreamStruct *stream, uint8_t last)
+{
+	uint8_t sum = 0;
+
+	if(0 == stream->num)
+	{
+		return;
+	}
+	stream->buf[1] = stream->len + 1;
+	stream->buf[5] = (stream->part++ & 0x7F) | (last ? MINIP_STREAM_LAST_FLAG : 0);
+	stream->buf[6] = stream->num;
+	for(uint8_t k = 0; k < stream->len; k++)
+	{
+		sum += stream->buf[k];
+	}
+	stream->buf[stream->len] = sum;
+
+	if(stream->write_func(stream->buf, stream->len + 1) == stream->len + 1)
+	{
+		stream->frame_cnt++;
+	}
+	else
+	{
+		// 接收端没有收到这一帧中的样本，清空差分基准，之后的样本都以完整样本发送
+		stream->drop_cnt++;
+		stream->dev_num = 0;
+	}
+	stream->len = 0;
+	stream->num = 0;
+}
+
+/**
+  * @描述   开始一帧，填写帧头、ID和周期序号
+  * @参数   stream：打包状态
+  * @返回值 无
+  */
+static void frame_start(MinipStreamStruct *stream)
+{
+	stream->buf[0] = MINIP_STREAM_HEAD;
+	stream->buf[2] = stream->delta ? MINIP_STREAM_ID_DELTA : MINIP_STREAM_ID_SAMPLE;
+	put_le(&stream->buf[3], stream->seq, 2);
+	stream->len = MINIP_STREAM_HEADER_LEN;
+	stream->num = 0;
+}
+
+/**
+  * @描述   初始化二进制上传
+  * @参数   stream：打包状态
+  * @参数   write：发送函数
+  * @返回值 无
+  */
+void MinipStreamInit(MinipStreamStruct *stream, StreamWriteFuncPtr write)
+{
+	memset(stream, 0, sizeof(MinipStreamStruct));
+	stream->write_func   = write;
+	stream->key_interval = MINIP_STREAM_KEY_INTERVAL;
+}
+
+/**
+  * @描述   设置差分压缩，修改后从下一个周期开始生效，第一个周期为关键帧
+  * @参数   stream：打包状态
+  * @参数   enable：1差分压缩格式，0完整格式
+  * @参数   key_interval：关键帧间隔，单位为周期，为0时使用MINIP_STREAM_KEY_INTERVAL
+  * @返回值 无
+  */
+void MinipStreamDeltaInit(MinipStreamStruct *stream, uint8_t enable, uint16_t key_interval)
+{
+	stream->delta        = enable;
+	stream->key_interval = (key_interval > 0) ? key_interval : MINIP_STREAM_KEY_INTERVAL;
+	stream->key_cnt      = 0;
+	stream->dev_num      = 0;
+}
+
+/**
+  * @描述   开始一个采集周期，上一个周期发送过样本时周期序号加1，没有样本的周期不占用序号，接收端不会误判为丢帧。
+  *         差分压缩时每隔key_interval个周期清空基准，本周期的样本都以完整样本发送。
+  * @参数   stream：打包状态
+  * @返回值 无
+  */
+void MinipStreamBegin(MinipStreamStruct *stream)
+{
+	if(stream->part > 0)
+	{
+		stream->seq++;
+		stream->part = 0;
+	}
+	if(++stream->key_cnt >= stream->key_interval)
+	{
+		stream->key_cnt = 0;
+		stream->dev_num = 0;
+	}
+	frame_start(stream);
+}
+
+/**
+  * @描述   加入一台雷达的样本，当前帧放不下时先发送当前帧
+  * @参数   stream：打包状态
+  * @参数   addr：从机地址
+  * @参数   data：测距结果
+  * @返回值 无
+  */
+void MinipStreamAdd(MinipStreamStruct *stream, uint8_t addr, const MinipDataStruct *data)
+{
+	uint8_t sample[MINIP_STREAM_SAMPLE_LEN + 3];
+	uint8_t n;
+
+	// 先发送放不下的当前帧再编码，发送失败时清空的基准对本样本生效
+	if(stream->len + MINIP_STREAM_SAMPLE_LEN + 1 > MINIP_STREAM_FRAME_MAX)
+	{
+		frame_flush(stream, 0);
+		frame_start(stream);
+	}
+	n = sample_encode(stream, addr, data, sample);
+	memcpy(&stream->buf[stream->len], sample, n);
+	stream->len += n;
+	stream->num++;
+}
+
+/**
+  * @描述   结束一个采集周期，发送未满的最后一帧
+  * @参数   stream：打包状态
+  * @返回值 无
+  */
+void MinipStreamEnd(MinipStreamStruct *stream)
+{
+	frame_flush(stream, 1);
+}
@@ -0,0 +1,95 @@
+#ifndef _TFMINIP_STREAM_H
+#define _TFMINIP_STREAM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include "tfminip_i2c_driver.h"
+
+/**
+  * 测距结果的二进制上传格式，沿用frame模块的默认帧格式 | 帧头 | 帧长 | ID | 负载 | 校验和 |：
+  *   帧头   MINIP_STREAM_HEAD
+  *   帧长   整帧的字节数，包括帧头和校验和
+  *   ID     MINIP_STREAM_ID_SAMPLE
+  *   负载   | 周期序号(2) | 帧序号(1) | 样本数n(1) | n个样本 |，每个样本为 | 从机地址(1) | dist(2) | amp(2) | tick_ms(4) |
+  *   校验和 之前所有字节之和的低8位
+  * 多字节数据均为小端。一个周期的样本放不下一帧时分为多帧，各帧的周期序号相同，帧序号低7位从0开始依次加1，
+  * 周期的最后一帧帧序号最高位为1。周期序号只对发送了样本的周期加1，接收端据此发现丢失的帧：
+  * 下一帧应为同一周期的下一个帧序号，或上一帧为周期的最后一帧时为下一个周期序号的0号帧。
+  *
+  * 差分压缩格式的帧结构相同，ID为MINIP_STREAM_ID_DELTA，每个样本的第一个字节为从机地址：
+  *   最高位为1时为完整样本，之后与上面的样本格式相同；
+  *   最高位为0时为差分样本，之后为一个varint：(dist之差 << 2) | 标志，标志位0为1时后面跟一个amp之差的varint，
+  *   标志位1为1时后面跟一个tick_ms之差的变化量(本次tick之差减去上次tick之差)的varint，为0时对应的值为0。
+  *   差值为有符号数，经zigzag变换后按varint编码，每字节低7位为数据、最高位为1表示后面还有字节，低位在前。
+  *   静止的场景中差分样本一般只有2个字节。
+  * 解码端以该雷达最近一次的样本为基准还原；基准在上一次完整样本之后开始，tick之差的初值为0。
+  * 每隔key_interval个周期所有样本都以完整样本发送(关键帧)，中途接入或校验出错的接收端在关键帧后恢复解码。
+  */
+#define MINIP_STREAM_HEAD           (0x5A)
+#define MINIP_STREAM_ID_SAMPLE      (0x80)
+#define MINIP_STREAM_ID_DELTA       (0x81)
+#define MINIP_STREAM_RAW_FLAG       (0x80)  // 差分压缩格式中完整样本的标志，位于从机地址字节的最高位
+#define MINIP_STREAM_AMP_FLAG       (0x01)  // 差分样本中后面跟有amp之差
+#define MINIP_STREAM_TICK_FLAG      (0x02)  // 差分样本中后面跟有tick之差的变化量
+#define MINIP_STREAM_FRAME_MAX      (255)   // 帧长字节为8位，一帧最长255字节
+#define MINIP_STREAM_LAST_FLAG      (0x80)  // 帧序号的最高位，周期的最后一帧
+#define MINIP_STREAM_HEADER_LEN     (7)     // 帧头、帧长、ID、周期序号、帧序号和样本数
+#define MINIP_STREAM_SAMPLE_LEN     (9)
+#ifndef MINIP_STREAM_MAX_DEV
+#define MINIP_STREAM_MAX_DEV        (16)    // 差分压缩时记录基准的最大雷达数量，超出的雷达总以完整样本发送
+#endif
+#define MINIP_STREAM_KEY_INTERVAL   (100)   // 默认的关键帧间隔，单位为周期
+
+/**
+  * @描述   发送函数，不阻塞，返回实际发送的长度，例如BspUartWrite
+  * @参数   buf：数据
+  * @参数   len：数据长度
+  * @返回值 实际发送的长度
+  */
+typedef uint16_t (*StreamWriteFuncPtr)(const uint8_t *buf, uint16_t len);
+
+/**
+  * @描述   差分压缩时一台雷达的基准，即最近一次发送的样本
+  */
+typedef struct
+{
+	uint8_t  addr;
+	uint16_t dist;
+	uint16_t amp;
+	uint32_t tick_ms;
+	uint32_t dtick;         // 最近一次的tick之差
+}MinipStreamDevStruct;
+
+/**
+  * @描述   二进制上传的打包状态，样本先放入buf，一帧装满或周期结束时整帧发送
+  */
+typedef struct
+{
+	StreamWriteFuncPtr write_func;
+	uint8_t  buf[MINIP_STREAM_FRAME_MAX];
+	uint8_t  len;           // buf中已打包的字节数，0表示没有未发送的帧
+	uint8_t  num;           // buf中的样本数
+	uint16_t seq;           // 当前周期序号
+	uint8_t  part;          // 本周期已发送的帧数，即下一帧的帧序号
+	uint32_t frame_cnt;     // 已发送的帧数
+	uint32_t drop_cnt;      // 发送函数未能全部接收而丢弃的帧数
+	uint8_t  delta;         // 1差分压缩格式，0完整格式
+	uint16_t key_interval;  // 关键帧间隔
+	uint16_t key_cnt;       // 距上一个关键帧的周期数
+	MinipStreamDevStruct dev[MINIP_STREAM_MAX_DEV];
+	uint8_t  dev_num;       // 已有基准的雷达数量，为0时所有样本都以完整样本发送
+}MinipStreamStruct;
+
+void MinipStreamInit(MinipStreamStruct *stream, StreamWriteFuncPtr write);
+void MinipStreamDeltaInit(MinipStreamStruct *stream, uint8_t enable, uint16_t key_interval);
+void MinipStreamBegin(MinipStreamStruct *stream);
+void MinipStreamAdd(MinipStreamStruct *stream, uint8_t addr, const MinipDataStruct *data);
+void MinipStreamEnd(MinipStreamStruct *stream);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,120 @@
+/**
+  ******************************************************************************
+  * @文件    tfminip_trace.c
+  * @描述    将跟踪事件注册为SystemView的一个模块，事件名称和参数格式由模块描述给出，
+  *          在SystemView的时间轴上可以直接看到每个事件及其参数。总线事务和PC指令处理另外记录为
+  *          SystemView的用户事件(OnUserStart/OnUserStop)，在时间轴上显示为区间并统计耗时。
+  ******************************************************************************
+  */
+#include "tfminip_trace.h"
+
+#if MINIP_TRACE_EN
+
+#include "SEGGER_SYSVIEW.h"
+#include <stddef.h>
+
+static void trace_send_desc(void);
+
+// 每条描述不能超过SEGGER_SYSVIEW_MAX_STRING_LEN(默认128)个字符，超出部分不会发送，
+// 放不下的事件描述由trace_send_desc另外发送
+static SEGGER_SYSVIEW_MODULE trace_module =
+{
+	"M=TFminiP, "
+	"0 XferStart addr=%u id=%u, "
+	"1 XferEnd addr=%u id=%u status=%u, "
+	"2 BusReset, "
+	"3 ScanStart probe=%u",
+	MINIP_TRACE_EVENT_NUM,
+	0,
+	trace_send_desc,
+	NULL
+};
+
+/** 
+  * @描述   SystemView连接时发送模块描述的其余部分
+  * @参数   无
+  * @返回值 无
+  */
+static void trace_send_desc(void)
+{
+	SEGGER_SYSVIEW_RecordModuleDescription(&trace_module,
+		"4 ScanEnd dev=%u, "
+		"5 FrameSearch ret=%u, "
+		"6 PcCmdStart id=%u, "
+		"7 PcCmdEnd id=%u");
+}
+
+/** 
+  * @描述   向SystemView注册跟踪模块，须在SEGGER_SYSVIEW_Conf之后、记录任何事件之前调用
+  * @参数   无
+  * @返回值 无
+  */
+void MinipTraceInit(void)
+{
+	SEGGER_SYSVIEW_RegisterModule(&trace_module);
+}
+
+/** 
+  * @描述   记录不带参数的事件
+  * @参数   event：事件，见MinipTraceEventEnum
+  * @返回值 无
+  */
+void MinipTraceRecord(uint8_t event)
+{
+	SEGGER_SYSVIEW_RecordVoid(trace_module.EventOffset + event);
+}
+
+/** 
+  * @描述   记录带1个参数的事件
+  * @参数   event：事件，见MinipTraceEventEnum
+  * @参数   para0：参数
+  * @返回值 无
+  */
+void MinipTraceRecord1(uint8_t event, uint32_t para0)
+{
+	SEGGER_SYSVIEW_RecordU32(trace_module.EventOffset + event, para0);
+}
+
+/** 
+  * @描述   记录带2个参数的事件
+  * @参数   event：事件，见MinipTraceEventEnum
+  * @参数   para0、para1：参数
+  * @返回值 无
+  */
+void MinipTraceRecord2(uint8_t event, uint32_t para0, uint32_t para1)
+{
+	SEGGER_SYSVIEW_RecordU32x2(trace_module.EventOffset + event, para0, para1);
+}
+
+/** 
+  * @描述   记录带3个参数的事件
+  * @参数   event：事件，见MinipTraceEventEnum
+  * @参数   para0、para1、para2：参数
+  * @返回值 无
+  */
+void MinipTraceRecord3(uint8_t event, uint32_t para0, uint32_t para1, uint32_t para2)
+{
+	SEGGER_SYSVIEW_RecordU32x3(trace_module.EventOffset + event, para0, para1, para2);
+}
+
+/** 
+  * @描述   开始一个区间，SystemView按用户事件统计区间的次数和耗时
+  * @参数   span：区间，见MinipTraceSpanEnum
+  * @返回值 无
+  */
+void MinipTraceSpanStart(uint8_t span)
+{
+	SEGGER_SYSVIEW_OnUserStart(span);
+}
+
+/** 
+  * @描述   结束一个区间
+  * @参数   span：区间，见MinipTraceSpanEnum
+  * @返回值 无
+  */
+void MinipTraceSpanStop(uint8_t span)
+{
+	SEGGER_SYSVIEW_OnUserStop(span);
+}
+
+#endif
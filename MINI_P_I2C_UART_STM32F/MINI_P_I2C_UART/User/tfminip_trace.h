@@ -0,0 +1,88 @@
+/**
+  ******************************************************************************
+  * @文件    tfminip_trace.h
+  * @描述    SystemView事件跟踪点。MINIP_TRACE_EN为0时所有跟踪宏为空，不产生任何代码，
+  *          驱动仍可以脱离SystemView在PC上编译。在编译选项中定义MINIP_TRACE_EN=1开启。
+  ******************************************************************************
+  */
+
+#ifndef _TFMINIP_TRACE_H
+#define _TFMINIP_TRACE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#ifndef MINIP_TRACE_EN
+#define MINIP_TRACE_EN    (0)
+#endif
+
+/** 
+  * @描述  跟踪事件枚举，与SystemView模块描述中的事件序号一一对应
+  */
+typedef enum
+{
+	MINIP_TRACE_XFER_START = 0,   /*!< 总线事务开始，参数为从机地址和指令ID */
+	MINIP_TRACE_XFER_END,         /*!< 总线事务结束，参数为从机地址、指令ID和结果 */
+	MINIP_TRACE_BUS_RESET,        /*!< 总线复位                         */
+	MINIP_TRACE_SCAN_START,       /*!< 总线扫描开始，参数为待探测的地址数    */
+	MINIP_TRACE_SCAN_END,         /*!< 总线扫描结束，参数为设备数量        */
+	MINIP_TRACE_FRAME_SEARCH,     /*!< 搜索PC指令帧，参数为搜索结果        */
+	MINIP_TRACE_PC_CMD_START,     /*!< 开始处理PC指令，参数为指令ID       */
+	MINIP_TRACE_PC_CMD_END,       /*!< PC指令处理结束，参数为指令ID       */
+	MINIP_TRACE_EVENT_NUM
+}MinipTraceEventEnum;
+
+/** 
+  * @描述  跟踪区间枚举，即SystemView用户事件的ID
+  */
+typedef enum
+{
+	MINIP_TRACE_SPAN_XFER = 0,    /*!< 一次总线事务                      */
+	MINIP_TRACE_SPAN_PC_CMD       /*!< 处理一条PC指令                    */
+}MinipTraceSpanEnum;
+
+#if MINIP_TRACE_EN
+
+void MinipTraceInit(void);
+void MinipTraceRecord(uint8_t event);
+void MinipTraceRecord1(uint8_t event, uint32_t para0);
+void MinipTraceRecord2(uint8_t event, uint32_t para0, uint32_t para1);
+void MinipTraceRecord3(uint8_t event, uint32_t para0, uint32_t para1, uint32_t para2);
+void MinipTraceSpanStart(uint8_t span);
+void MinipTraceSpanStop(uint8_t span);
+
+#define MINIP_TRACE_INIT()                      MinipTraceInit()
+#define MINIP_TRACE_XFER_BEGIN(addr, id)        do { MinipTraceSpanStart(MINIP_TRACE_SPAN_XFER); \
+                                                     MinipTraceRecord2(MINIP_TRACE_XFER_START, (addr), (id)); } while(0)
+#define MINIP_TRACE_XFER_DONE(addr, id, status) do { MinipTraceRecord3(MINIP_TRACE_XFER_END, (addr), (id), (status)); \
+                                                     MinipTraceSpanStop(MINIP_TRACE_SPAN_XFER); } while(0)
+#define MINIP_TRACE_RESET()                     MinipTraceRecord(MINIP_TRACE_BUS_RESET)
+#define MINIP_TRACE_SCAN_BEGIN(num)             MinipTraceRecord1(MINIP_TRACE_SCAN_START, (num))
+#define MINIP_TRACE_SCAN_DONE(num)              MinipTraceRecord1(MINIP_TRACE_SCAN_END, (num))
+#define MINIP_TRACE_FRAME(ret)                  MinipTraceRecord1(MINIP_TRACE_FRAME_SEARCH, (ret))
+#define MINIP_TRACE_PC_CMD_BEGIN(id)            do { MinipTraceSpanStart(MINIP_TRACE_SPAN_PC_CMD); \
+                                                     MinipTraceRecord1(MINIP_TRACE_PC_CMD_START, (id)); } while(0)
+#define MINIP_TRACE_PC_CMD_DONE(id)             do { MinipTraceRecord1(MINIP_TRACE_PC_CMD_END, (id)); \
+                                                     MinipTraceSpanStop(MINIP_TRACE_SPAN_PC_CMD); } while(0)
+
+#else
+
+#define MINIP_TRACE_INIT()                      ((void)0)
+#define MINIP_TRACE_XFER_BEGIN(addr, id)        ((void)0)
+#define MINIP_TRACE_XFER_DONE(addr, id, status) ((void)0)
+#define MINIP_TRACE_RESET()                     ((void)0)
+#define MINIP_TRACE_SCAN_BEGIN(num)             ((void)0)
+#define MINIP_TRACE_SCAN_DONE(num)              ((void)0)
+#define MINIP_TRACE_FRAME(ret)                  ((void)0)
+#define MINIP_TRACE_PC_CMD_BEGIN(id)            ((void)0)
+#define MINIP_TRACE_PC_CMD_DONE(id)             ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif
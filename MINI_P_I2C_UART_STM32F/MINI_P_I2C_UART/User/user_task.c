@@ -10,13 +10,31 @@
 #include "cmsis_os.h"
 #include "usart.h"
 #include "bsp_i2c.h"
+#include "bsp_uart.h"
 #include <string.h>
 #include "tfminip_i2c_driver.h"
+#include "tfminip_trace.h"
+#include "tfminip_sched.h"
+#include "tfminip_stream.h"
 #include "frame.h"
 
-// 以下两个ID是为调试方便临时定义的指令，调试用
+// 以下ID是为调试方便临时定义的指令，调试用
 #define ID_ADA            (0x40)
 #define ID_SCAN_BUS       (0x41)
+#define ID_SYNC_MODE      (0x42)
+#define ID_ERR_STAT       (0x43)
+#define ID_PERF_STAT      (0x44)
+#define ID_SENSOR_RATE    (0x45)
+#define ID_STREAM_MODE    (0x46)
+#define ID_BAUD_RATE      (0x47)
+
+#define HOTPLUG_STEP      (2)     // 每个采集周期最多探测的未使用地址数
+#define SCHED_TICK_US     (1000)  // 连续测量模式下的调度间隔，与主循环周期一致
+#define SCHED_COST_US     (500)   // 400kHz下读取一台雷达的总线用时，可以用ID_PERF_STAT实测后修改
+#define SCHED_BUDGET      (800)   // 读取最多占用总线时间的80%，其余留给热插拔探测和配置指令
+#define BAUD_ERR_MAX      (20000) // 允许的波特率误差，单位百万分之一
+#define BAUD_FLUSH_MS     (500)   // 切换波特率前等待发送缓冲发完的最长时间
+#define BAUD_CONFIRM_MS   (1000)  // 切换后等待PC以新波特率确认的时间，超时恢复原波特率
 
 // 以下ID是雷达通信协议中的部分指令，在这里发送给I2C主控板，代为转发，调试用
 #define ID_SOFT_RESET     (0x02)
@@ -25,40 +43,131 @@
 #define ID_I2C_SLAVE_ADDR (0x0B)
 #define ID_SAVE_SETTINGS  (0x11)
 
+// 波特率切换状态，调试用
+typedef struct
+{
+	uint8_t  pending;   // 1已切换到新波特率，等待PC确认
+	uint32_t old;       // 切换前的波特率，未确认时恢复
+	uint32_t deadline;  // 等待确认的截止时刻，单位ms
+}BaudSwitchStruct;
+
 typedef struct
 {
 	uint16_t rate;
 	uint8_t  en;
+	uint8_t  sync;  // 0连续测量，1广播触发同步采集，2逐台触发同步采集
+	uint8_t  stream;  // 测距结果的上传格式，0文本，1二进制，2差分压缩的二进制，见tfminip_stream.h
 }ConfigParaStruct;
 
 // 用于处理PC下发的串口指令，调试用
 uint8_t         frame_buf_pc[256];
-Frame_HandlePtr hframe_pc;
+
+extern osThreadId UserTaskHandle;
 
 MinipDevListStruct   dev_list;  // 记录当前I2C总线上的设备状态
+MinipDevListStruct   poll_list; // 本周期轮询的雷达，由健康状态决定
+MinipDataStruct      data[127]; // 本周期的测距结果，与poll_list一一对应
+uint8_t              status[127];
+MinipSyncSampleStruct sync_sample[127]; // 同步采集模式下本周期的样本，与poll_list一一对应
+MinipAddrSetStruct   dev_added; // 上次处理之后新加入的雷达
+MinipSchedStruct     sched;     // 连续测量模式下各雷达的读取调度，每台雷达可以有不同的帧率
+MinipStreamStruct    stream;    // 测距结果的二进制上传
+BaudSwitchStruct     baud_switch;
+uint8_t              dev_changed;
 ConfigParaStruct     config;    // 用于记录当前雷达的工作状态，调试用，建议将雷达的工作帧率作为循环读取I2C总线的频率
 
-// 按照I2cWriteFuncPtr的形式，定义I2C写函数
-uint8_t i2c_write(uint8_t addr, uint8_t *buf, uint32_t size)
+// 将HAL的传输结果转换为驱动的详细状态
+uint8_t i2c_status(HAL_StatusTypeDef status, uint8_t async)
 {
-	HAL_StatusTypeDef status;
-	status = HAL_I2C_Master_Transmit(I2C_MASTER, addr << 1, buf, size, 100);
+	uint32_t err = HAL_I2C_GetError(I2C_MASTER);
+
 	if(HAL_OK == status)
 	{
 		return I2C_OK;
 	}
-	else
+	if(HAL_BUSY == status)
 	{
-		return I2C_ERROR;
+		return I2C_BUSY;
+	}
+	if(err & HAL_I2C_ERROR_ARLO)
+	{
+		return I2C_ARB_LOST;
 	}
+	if(err & HAL_I2C_ERROR_BERR)
+	{
+		return I2C_BUS_ERROR;
+	}
+	if(err & HAL_I2C_ERROR_AF)
+	{
+		return BspI2cNackAtAddr(async) ? I2C_ADDR_NACK : I2C_DATA_NACK;
+	}
+	if((HAL_TIMEOUT == status) || (err & HAL_I2C_ERROR_TIMEOUT))
+	{
+		return I2C_TIMEOUT;
+	}
+	return I2C_ERROR;
+}
+
+// 按照I2cWriteFuncPtr的形式，定义I2C写函数
+uint8_t i2c_write(uint8_t addr, uint8_t *buf, uint32_t size)
+{
+	return i2c_status(HAL_I2C_Master_Transmit(I2C_MASTER, addr << 1, buf, size, 100), 0);
 }
 
 // 按照I2cReadFuncPtr的形式，定义I2C读函数
 uint8_t i2c_read(uint8_t addr, uint8_t *buf, uint32_t size)
 {
-	HAL_StatusTypeDef status;
-	status = HAL_I2C_Master_Receive(I2C_MASTER, addr << 1, buf, size, 100);
-	if(HAL_OK == status)
+	return i2c_status(HAL_I2C_Master_Receive(I2C_MASTER, addr << 1, buf, size, 100), 0);
+}
+
+// 按照I2cProbeFuncPtr的形式，定义I2C地址探测函数，扫描总线时使用
+uint8_t i2c_probe(uint8_t addr)
+{
+	HAL_StatusTypeDef status = BspI2cProbe(addr);
+	if(HAL_ERROR == status)
+	{
+		return I2C_ADDR_NACK;  // HAL在探测结束时已清除AF标志，无应答以HAL_ERROR返回
+	}
+	return i2c_status(status, 0);
+}
+
+// 按照I2cWriteFuncPtr的形式，定义I2C异步写函数，数据由DMA搬运，传输结束后在中断中调用MinipBusXferCpltHandler
+uint8_t i2c_write_dma(uint8_t addr, uint8_t *buf, uint32_t size)
+{
+	return i2c_status(BspI2cMasterTransmitDma(addr, buf, size), 1);
+}
+
+// 按照I2cReadFuncPtr的形式，定义I2C异步读函数，数据由DMA搬运
+uint8_t i2c_read_dma(uint8_t addr, uint8_t *buf, uint32_t size)
+{
+	return i2c_status(BspI2cMasterReceiveDma(addr, buf, size), 1);
+}
+
+// 按照TickFuncPtr的形式，定义计时函数，使用DWT周期计数器，每微秒计数SystemCoreClock / 1000000
+uint32_t dwt_tick(void)
+{
+	return DWT->CYCCNT;
+}
+
+// 开启DWT周期计数器，调试器未连接时需要由程序开启，不清零计数值，以免影响SystemView的时间戳
+void dwt_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// 按照XferNotifyFuncPtr的形式，定义事务完成通知函数，在I2C中断中唤醒用户任务
+void i2c_xfer_notify(void)
+{
+	BaseType_t woken = pdFALSE;
+	vTaskNotifyGiveFromISR(UserTaskHandle, &woken);
+	portYIELD_FROM_ISR(woken);
+}
+
+// 按照XferWaitFuncPtr的形式，定义事务等待函数，用户任务阻塞在任务通知上
+uint8_t i2c_xfer_wait(uint32_t timeout)
+{
+	if(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout)) > 0)
 	{
 		return I2C_OK;
 	}
@@ -68,6 +177,148 @@ uint8_t i2c_read(uint8_t addr, uint8_t *buf, uint32_t size)
 	}
 }
 
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	if(I2C_MASTER == hi2c)
+	{
+		MinipBusXferCpltHandler(MinipDefaultBus(), I2C_OK);
+	}
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	if(I2C_MASTER == hi2c)
+	{
+		MinipBusXferCpltHandler(MinipDefaultBus(), I2C_OK);
+	}
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	if(I2C_MASTER == hi2c)
+	{
+		MinipBusXferCpltHandler(MinipDefaultBus(), i2c_status(HAL_ERROR, 1));
+	}
+}
+
+// 按照DevEventFuncPtr的形式，定义设备变化通知函数，调试用
+void dev_event(uint8_t addr, uint8_t event)
+{
+	printf("dev addr = 0x%02x %s\n", addr, (MINIP_DEV_ADDED == event) ? "added" : "removed");
+	if(MINIP_DEV_ADDED == event)
+	{
+		MinipAddrSetInsert(&dev_added, addr);
+	}
+	dev_changed = 1;
+}
+
+// 打印一组按结果分类的累计次数，调试用
+void PrintStat(const char *name, uint32_t *cnt)
+{
+	printf("%s ok=%u frame=%u addr_nack=%u data_nack=%u timeout=%u bus_err=%u arlo=%u busy=%u not_init=%u verify=%u other=%u\n", name,
+	       cnt[I2C_OK], cnt[I2C_FRAME_ERROR], cnt[I2C_ADDR_NACK], cnt[I2C_DATA_NACK], cnt[I2C_TIMEOUT],
+	       cnt[I2C_BUS_ERROR], cnt[I2C_ARB_LOST], cnt[I2C_BUSY], cnt[I2C_NOT_INIT], cnt[I2C_VERIFY_ERROR], cnt[I2C_ERROR]);
+}
+
+// I2C总线错误统计打印函数，addr为0时打印总线和所有地址的统计，调试用
+void PrintErrStat(uint8_t addr)
+{
+	uint32_t cnt[MINIP_STATUS_NUM];
+	MinipBus *bus = MinipDefaultBus();
+	char name[8];
+
+	if(0 != addr)
+	{
+		if(I2C_OK == MinipGetAddrStat(addr, cnt))
+		{
+			sprintf(name, "0x%02x", addr);
+			PrintStat(name, cnt);
+		}
+		else
+		{
+			printf("0x%02x no stat\n", addr);
+		}
+		return;
+	}
+
+	MinipGetBusStat(cnt);
+	printf("xfer=%u\n", bus->xfer_cnt);
+	PrintStat("bus ", cnt);
+	for(uint8_t k = 0; k < bus->stat_num; k++)
+	{
+		sprintf(name, "0x%02x", bus->stat[k].addr);
+		PrintStat(name, bus->stat[k].status_cnt);
+	}
+}
+
+// 将雷达加入读取调度，总线预算不足而降低帧率或未能加入时打印原因，调试用
+uint8_t SchedAddDev(uint8_t addr, uint16_t rate, uint8_t prio)
+{
+	uint8_t ret = MinipSchedAdd(&sched, addr, rate, prio, osKernelSysTick() * 1000);
+	if(MINIP_SCHED_REDUCED == ret)
+	{
+		printf("sched 0x%02x rate=%d reduced to %d: overload\n", addr, rate, MinipSchedGet(&sched, addr)->rate);
+	}
+	else if(MINIP_SCHED_OK != ret)
+	{
+		printf("sched 0x%02x rate=%d rejected: %s\n", addr, rate, (MINIP_SCHED_FULL == ret) ? "full" : "para error");
+	}
+	return ret;
+}
+
+// 处理PC的波特率指令，调试用。PC先以原波特率发送新波特率，收到回复后双方切换，PC再以新波特率发送同一指令确认；
+// 期限内没有收到确认时恢复原波特率，避免双方失去联系
+void BaudRateCmd(uint32_t baud)
+{
+	int32_t  err;
+	uint32_t actual;
+
+	if(baud_switch.pending)
+	{
+		if(baud == BspUartGetBaud())
+		{
+			baud_switch.pending = 0;
+			printf("baud %u confirmed\n", baud);
+		}
+		return;
+	}
+
+	actual = BspUartBaudCalc(baud, &err);
+	if((0 == actual) || (err > BAUD_ERR_MAX) || (err < -BAUD_ERR_MAX))
+	{
+		printf("baud %u rejected actual=%u err=%dppm max=%u\n", baud, actual, err, BspUartBaudCalc(UART_PC_PCLK() / 16, NULL));
+		return;
+	}
+	// 缓冲中的数据和回复都须以原波特率发完才能切换，发不完时放弃切换，PC保持原波特率
+	if(HAL_OK != BspUartTxFlush(BAUD_FLUSH_MS))
+	{
+		printf("baud %u aborted: tx flush timeout\n", baud);
+		return;
+	}
+	printf("baud %u actual=%u err=%dppm confirm in %ums\n", baud, actual, err, BAUD_CONFIRM_MS);
+	if(HAL_OK != BspUartTxFlush(BAUD_FLUSH_MS))
+	{
+		printf("baud %u aborted: tx flush timeout\n", baud);
+		return;
+	}
+	baud_switch.old      = BspUartGetBaud();
+	baud_switch.deadline = osKernelSysTick() + BAUD_CONFIRM_MS;
+	baud_switch.pending  = 1;
+	BspUartSetBaud(baud);
+}
+
+// 读取调度统计打印函数，调试用
+void PrintSchedStat(void)
+{
+	printf("sched load=%u.%u%%\n", MinipSchedLoadPermille(&sched) / 10, MinipSchedLoadPermille(&sched) % 10);
+	for(uint8_t k = 0; k < sched.num; k++)
+	{
+		MinipSchedEntryStruct *entry = &sched.entry[k];
+		printf("0x%02x rate=%d prio=%d frame=%uus defer=%u skip=%u stale=%u\n", entry->addr, entry->rate, entry->prio,
+		       entry->frame_us, entry->defer_cnt, entry->skip_cnt, entry->stale_cnt);
+	}
+}
+
 // I2C总线设备信息打印函数，调试用
 void PrintDevList(void)
 {
@@ -90,22 +341,37 @@ void PrintDevList(void)
 // 初始化配置函数
 void DataStreamInit(void)
 {
-	hframe_pc    = Frame_New(256, frame_buf_pc, 256);
-	Frame_SetHead(hframe_pc, 0x5A);
-	Frame_SetCheckArith(hframe_pc, FRAME_CHECK_NONE);
 	MinipI2cInit(i2c_write, i2c_read, BspI2cResetBus, (DelayMsFuncPtr)osDelay);
-	dev_list = MinipI2cScanBus();
+	MinipBusAsyncInit(MinipDefaultBus(), i2c_write_dma, i2c_read_dma, i2c_xfer_notify, i2c_xfer_wait);
+	MinipScanInit(i2c_probe, BspI2cBusStuck);
+	MinipHotplugInit(HOTPLUG_STEP, dev_event);
+	MinipVerifyInit(1);
+	MinipAdaptiveWaitInit(1);
+	dwt_init();
+	MINIP_TRACE_INIT();
+	MinipTimingInit(dwt_tick, SystemCoreClock / 1000000);
+	(void)MinipI2cScanBus(&dev_list);
 	PrintDevList();
 	if(dev_list.num > 0)
 	{
 		MinipGetSampleRate(dev_list.addr_list[0], &config.rate);
 		MinipGetStatus(dev_list.addr_list[0], &config.en);
+		if(config.rate < 1)
+		{
+			config.rate = 1;  // 读取失败或雷达处于单次触发模式时，以1Hz读取总线
+		}
 	}
 	else
 	{
 		config.rate = 1;
 		config.en = 0;
 	}
+	MinipStreamInit(&stream, BspUartWrite);
+	MinipSchedInit(&sched, SCHED_TICK_US, SCHED_COST_US, SCHED_BUDGET);
+	for(uint8_t n = 0; n < dev_list.num; n++)
+	{
+		(void)SchedAddDev(dev_list.addr_list[n], config.rate, 0);
+	}
 }
 
 // 主任务函数
@@ -113,46 +379,181 @@ void StartUserTask(void const * argument)
 {
   /* USER CODE BEGIN StartDataStreamProcTask */
   osDelay(1000);
-  MinipDataStruct data;
   uint32_t PreviousWakeTime = osKernelSysTick();
+  uint32_t cycle_ms = 0;
   
   DataStreamInit();
   MinipTimestampSync(0, 0);
   /* Infinite loop */
   for(;;)
   {
-	osDelayUntil(&PreviousWakeTime, 1000 / config.rate);
+	// 同步采集以config.rate为周期；连续测量每1ms调度一次，各雷达按各自的帧率读取
+	uint32_t tick_ms = config.sync ? 1000 / config.rate : SCHED_TICK_US / 1000;
+	osDelayUntil(&PreviousWakeTime, tick_ms);
+	MinipPerfPoll(&MinipDefaultBus()->perf);
 
-	if(config.en)
+	// 等待波特率确认期间暂停输出测距结果，PC以新波特率收到的第一条数据就是确认回复
+	if(baud_switch.pending && ((int32_t)(osKernelSysTick() - baud_switch.deadline) >= 0))
 	{
-		for(uint8_t n = 0; n < dev_list.num; n++)
+		baud_switch.pending = 0;
+		BspUartSetBaud(baud_switch.old);
+		printf("baud fallback to %u\n", baud_switch.old);
+	}
+
+	if(!baud_switch.pending && config.en && config.sync)
+	{
+		// 同步采集：触发所有雷达后读取本周期的结果，只轮询健康状态允许的雷达
+		uint8_t n = MinipHealthSelect(&poll_list);
+		(void)MinipSyncCapture(poll_list.addr_list, n, config.sync - 1, sync_sample);
+		MinipStreamBegin(&stream);
+		for(uint8_t k = 0; k < n; k++)
+		{
+			MinipHealthReport(poll_list.addr_list[k], sync_sample[k].status);
+			if(I2C_OK != sync_sample[k].status)
+			{
+				continue;
+			}
+			if(config.stream)
+			{
+				MinipStreamAdd(&stream, poll_list.addr_list[k], &sync_sample[k].data);
+			}
+			else
+			{
+				printf("<%d>[0x%02x] dist=%5d amp=%5d tick=%12d      ", sync_sample[k].cycle, poll_list.addr_list[k], sync_sample[k].data.dist, sync_sample[k].data.amp, sync_sample[k].data.tick_ms);
+			}
+		}
+		if(config.stream)
+		{
+			MinipStreamEnd(&stream);
+		}
+		else
+		{
+			printf("\n");
+		}
+	}
+	else if(!baud_switch.pending && config.en)
+	{
+		// 调度器选出本次到期的雷达，再按健康状态过滤后批量读取，个别雷达失败时只退避该雷达
+		// 读到的时间戳用于锁定各雷达的出帧相位，下次读取安排在雷达下一帧刚好可以读到之后；时间戳未变化的重复数据不输出
+		uint32_t now_us = osKernelSysTick() * 1000;
+		poll_list.num = MinipSchedSelect(&sched, now_us, poll_list.addr_list);
+		uint8_t n = MinipHealthFilter(&poll_list);
+		if(n > 0)
 		{
-			// 读取雷达测距结果
-			if(I2C_OK == MinipReadData(dev_list.addr_list[n], &data))
+			(void)MinipReadDataMany(poll_list.addr_list, n, data, status);
+			MinipStreamBegin(&stream);
+			for(uint8_t k = 0; k < n; k++)
+			{
+				MinipHealthReport(poll_list.addr_list[k], status[k]);
+				if((I2C_OK != status[k]) || MinipSchedUpdate(&sched, poll_list.addr_list[k], data[k].tick_ms, now_us))
+				{
+					continue;
+				}
+				if(config.stream)
+				{
+					MinipStreamAdd(&stream, poll_list.addr_list[k], &data[k]);
+				}
+				else
+				{
+					printf("[0x%02x] dist=%5d amp=%5d tick=%12d      ", poll_list.addr_list[k], data[k].dist, data[k].amp, data[k].tick_ms);
+				}
+			}
+			if(config.stream)
 			{
-				printf("[%d] dist=%5d amp=%5d tick=%12d      ", n, data.dist, data.amp, data.tick_ms);
+				MinipStreamEnd(&stream);
 			}
 			else
 			{
-				dev_list = MinipI2cScanBus();
-				PrintDevList();
+				printf("\n");
+			}
+		}
+	}
+
+	// 每个采集周期利用剩余的总线时间探测少量未使用的地址，发现新接入的雷达
+	cycle_ms += tick_ms;
+	if(cycle_ms >= 1000 / config.rate)
+	{
+		cycle_ms = 0;
+		(void)MinipHotplugStep(NULL);
+	}
+	if(dev_changed)
+	{
+		dev_changed = 0;
+		(void)MinipAddrSetToList(&MinipDefaultBus()->dev_set, &dev_list);
+		if(config.sync)
+		{
+			// 只把新加入的雷达设为单次触发模式
+			for(uint8_t addr = 1; addr <= 127; addr++)
+			{
+				if(MinipAddrSetContains(&dev_added, addr))
+				{
+					MinipSetSampleRate(addr, 0);
+				}
+			}
+		}
+		// 新加入的雷达按当前帧率加入调度，已移除的雷达退出调度
+		for(uint8_t k = sched.num; k > 0; k--)
+		{
+			if(!MinipAddrSetContains(&MinipDefaultBus()->dev_set, sched.entry[k - 1].addr))
+			{
+				MinipSchedRemove(&sched, sched.entry[k - 1].addr);
+			}
+		}
+		for(uint8_t addr = 1; addr <= 127; addr++)
+		{
+			if(MinipAddrSetContains(&dev_added, addr) && (NULL == MinipSchedGet(&sched, addr)))
+			{
+				(void)SchedAddDev(addr, config.rate, 0);
 			}
 		}
-		printf("\n");
+		MinipAddrSetClear(&dev_added);
 	}
-	
-	// 以下解析和处理PC下发的串口指令，调试用
-	if(FRAME_OK == Frame_Search(hframe_pc))
+
+	// 以下解析和处理PC下发的串口指令，调试用。每个周期处理接收缓冲中所有完整的指令，避免连续下发时积压
+	Frame_StatusEnum frame_ret;
+	while(FRAME_OK == (frame_ret = BspUartFrameSearch(0x5A, frame_buf_pc, sizeof(frame_buf_pc))))
 	{
+		MINIP_TRACE_FRAME(frame_ret);  // 没有数据时每个周期都是FRAME_LESS，不记录
 		uint8_t id = frame_buf_pc[2];
+		MINIP_TRACE_PC_CMD_BEGIN(id);
 		switch (id)
 		{
 			case ID_ADA:
-				dev_list = MinipAddrDynamicAllocation(0x10);
+				(void)MinipAddrDynamicAllocation(0x10, &dev_list);
 				PrintDevList();
 				break;
+			case ID_ERR_STAT:
+				if(0xFF == frame_buf_pc[3])
+				{
+					MinipClearStat();
+				}
+				else
+				{
+					PrintErrStat(frame_buf_pc[3]);
+				}
+				break;
+			case ID_PERF_STAT:
+				if(0xFF == frame_buf_pc[3])
+				{
+					MinipPerfClear(&MinipDefaultBus()->perf);
+				}
+				else
+				{
+					MinipPerfDump(&MinipDefaultBus()->perf, printf);
+					PrintSchedStat();
+					printf("uart tx drop=%u rx overrun=%u stream frame=%u drop=%u\n", BspUartTxDropCount(), BspUartRxOverrunCount(), stream.frame_cnt, stream.drop_cnt);
+				}
+				break;
+			case ID_BAUD_RATE:
+				BaudRateCmd((uint32_t)frame_buf_pc[3] | ((uint32_t)frame_buf_pc[4] << 8) | ((uint32_t)frame_buf_pc[5] << 16) | ((uint32_t)frame_buf_pc[6] << 24));
+				break;
+			case ID_STREAM_MODE:
+				config.stream = (frame_buf_pc[3] > 2) ? 0 : frame_buf_pc[3];
+				MinipStreamDeltaInit(&stream, (2 == config.stream) ? 1 : 0, MINIP_STREAM_KEY_INTERVAL);
+				break;
 			case ID_SCAN_BUS:
-				dev_list = MinipI2cScanBus();
+				MinipCacheInvalidate(0, MINIP_CACHE_ALL);  // PC主动扫描时重新读取雷达的版本号和配置
+				(void)MinipI2cScanBus(&dev_list);
 				PrintDevList();
 				break;
 			case ID_SOFT_RESET:
@@ -169,7 +570,43 @@ void StartUserTask(void const * argument)
 				{
 					config.rate = 1000;
 				}
-				MinipSetSampleRate(0, config.rate);
+				if(!config.sync)
+				{
+					MinipSetSampleRate(0, config.rate);
+				}
+				for(uint8_t k = 0; k < sched.num; k++)
+				{
+					(void)SchedAddDev(sched.entry[k].addr, config.rate, sched.entry[k].prio);
+				}
+				break;
+			case ID_SENSOR_RATE:
+			{
+				// 单独设置一台雷达的帧率和调度优先级，例如前向雷达500Hz、侧向雷达20Hz共用一条总线
+				uint8_t  addr = frame_buf_pc[3];
+				uint16_t rate = (uint16_t)frame_buf_pc[4] + ((uint16_t)frame_buf_pc[5] << 8);
+				uint8_t  ret  = SchedAddDev(addr, rate, frame_buf_pc[6]);
+				if((MINIP_SCHED_OK == ret) || (MINIP_SCHED_REDUCED == ret))
+				{
+					rate = MinipSchedGet(&sched, addr)->rate;
+					if(!config.sync)
+					{
+						MinipSetSampleRate(addr, rate);
+					}
+					printf("sched 0x%02x rate=%d prio=%d load=%u.%u%%\n", addr, rate, frame_buf_pc[6],
+					       MinipSchedLoadPermille(&sched) / 10, MinipSchedLoadPermille(&sched) % 10);
+				}
+				break;
+			}
+			case ID_SYNC_MODE:
+				config.sync = (frame_buf_pc[3] > 2) ? 0 : frame_buf_pc[3];
+				if(config.sync)
+				{
+					MinipSyncStart(dev_list.addr_list, dev_list.num);
+				}
+				else
+				{
+					MinipSyncStop(dev_list.addr_list, dev_list.num, config.rate);
+				}
 				break;
 			case ID_OUTPUT_EN:
 				config.en = frame_buf_pc[3];
@@ -191,6 +628,7 @@ void StartUserTask(void const * argument)
 			default:
 				break;
 		}
+		MINIP_TRACE_PC_CMD_DONE(id);
 	}
   }
   /* USER CODE END StartDownstreamProcTask */
@@ -0,0 +1,286 @@
+/**
+  ******************************************************************************
+  * @文件    minip_stream_decode.c
+  * @描述    PC端工具：解码转接板上传的二进制测距结果(0x46指令参数1或2)，每个样本输出一行
+  *          周期序号,从机地址,dist,amp,tick_ms。输入为串口录制的原始数据，其中夹杂的文本回复被跳过。
+  *          帧格式见User/tfminip_stream.h。校验出错或按周期序号、帧序号发现丢帧时清空所有雷达的基准，
+  *          差分样本在该雷达的下一个完整样本之后恢复解码，不会输出错误的数值。
+  *
+  * 编译：gcc -std=c99 -I../User -o minip_stream_decode minip_stream_decode.c
+  * 使用：minip_stream_decode 录制文件 > 输出.csv，不指定文件时从标准输入读取
+  * 检查：sh test/check_stream_decode.sh，用test/下录制的数据比较解码结果
+  ******************************************************************************
+  */
+#include <stdio.h>
+#include <string.h>
+#include "tfminip_stream.h"
+
+/**
+  * @描述   一台雷达的解码基准
+  */
+typedef struct
+{
+	uint8_t  valid;     // 已收到完整样本，可以还原差分样本
+	uint16_t dist;
+	uint16_t amp;
+	uint32_t tick_ms;
+	uint32_t dtick;
+}DecodeDevStruct;
+
+/**
+  * @描述   一个解码出的样本，整帧解码成功后才输出
+  */
+typedef struct
+{
+	uint8_t  addr;
+	uint16_t dist;
+	uint16_t amp;
+	uint32_t tick_ms;
+}DecodeRowStruct;
+
+static DecodeDevStruct dev[128];
+static DecodeRowStruct row[MINIP_STREAM_FRAME_MAX / 2];  // 差分样本最短2个字节
+static uint8_t  row_num;
+static uint32_t sample_cnt, skip_cnt, frame_cnt, bad_cnt, gap_cnt;
+static uint8_t  last_valid;  // 已收到过正确的帧
+static uint16_t last_seq;
+static uint8_t  last_part;
+
+static uint32_t get_le(const uint8_t *p, uint8_t n)
+{
+	uint32_t val = 0;
+	for(uint8_t k = 0; k < n; k++)
+	{
+		val |= (uint32_t)p[k] << (8 * k);
+	}
+	return val;
+}
+
+/**
+  * @描述   读取varint
+  * @参数   p：读取位置
+  * @参数   end：数据结束位置
+  * @参数   val：读出的无符号数
+  * @返回值 读取的字节数，数据不完整时返回0
+  */
+static uint8_t get_varint(const uint8_t *p, const uint8_t *end, uint32_t *val)
+{
+	uint32_t zz = 0;
+	uint8_t  n = 0;
+
+	do
+	{
+		if((p + n >= end) || (n >= 5))
+		{
+			return 0;
+		}
+		zz |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+	}while(p[n++] & 0x80);
+
+	*val = zz;
+	return n;
+}
+
+static int32_t unzigzag(uint32_t zz)
+{
+	return (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1);
+}
+
+static void put_sample(uint8_t addr, DecodeDevStruct *d)
+{
+	row[row_num].addr    = addr;
+	row[row_num].dist    = d->dist;
+	row[row_num].amp     = d->amp;
+	row[row_num].tick_ms = d->tick_ms;
+	row_num++;
+}
+
+/**
+  * @描述   检查帧是否紧接上一个正确的帧，即同一周期的下一个帧序号，或上一帧为周期的最后一帧时下一个周期的0号帧。
+  *         中间有帧丢失时之后的差分无法还原，清空所有雷达的基准。
+  * @参数   seq：周期序号
+  * @参数   part：帧序号
+  * @返回值 无
+  */
+static void seq_check(uint16_t seq, uint8_t part)
+{
+	uint8_t next;
+
+	if(last_part & MINIP_STREAM_LAST_FLAG)
+	{
+		next = ((uint16_t)(last_seq + 1) == seq) && (0 == (part & 0x7F));
+	}
+	else
+	{
+		next = (last_seq == seq) && (((last_part + 1) & 0x7F) == (part & 0x7F));
+	}
+	if(last_valid && !next)
+	{
+		gap_cnt++;
+		memset(dev, 0, sizeof(dev));
+	}
+	last_valid = 1;
+	last_seq   = seq;
+	last_part  = part;
+}
+
+/**
+  * @描述   解码一帧的负载，样本放入row[]
+  * @参数   id：帧ID
+  * @参数   p：负载，从周期序号开始
+  * @参数   end：负载结束位置，不含校验和
+  * @返回值 0正常，1负载格式错误
+  */
+static int decode_payload(uint8_t id, const uint8_t *p, const uint8_t *end)
+{
+	uint8_t num = p[3];
+
+	row_num = 0;
+	p += 4;
+	for(uint8_t k = 0; k < num; k++)
+	{
+		if(p >= end)
+		{
+			return 1;
+		}
+		uint8_t addr = p[0] & 0x7F;
+		DecodeDevStruct *d = &dev[addr];
+
+		if((MINIP_STREAM_ID_SAMPLE == id) || (p[0] & MINIP_STREAM_RAW_FLAG))
+		{
+			if(p + MINIP_STREAM_SAMPLE_LEN > end)
+			{
+				return 1;
+			}
+			d->valid   = 1;
+			d->dist    = (uint16_t)get_le(&p[1], 2);
+			d->amp     = (uint16_t)get_le(&p[3], 2);
+			d->tick_ms = get_le(&p[5], 4);
+			d->dtick   = 0;
+			p += MINIP_STREAM_SAMPLE_LEN;
+			put_sample(addr, d);
+			continue;
+		}
+
+		uint32_t head, zz_amp = 0, zz_tick = 0;
+		uint8_t  n;
+		p++;
+		if(0 == (n = get_varint(p, end, &head)))
+		{
+			return 1;
+		}
+		p += n;
+		if(head & MINIP_STREAM_AMP_FLAG)
+		{
+			if(0 == (n = get_varint(p, end, &zz_amp)))
+			{
+				return 1;
+			}
+			p += n;
+		}
+		if(head & MINIP_STREAM_TICK_FLAG)
+		{
+			if(0 == (n = get_varint(p, end, &zz_tick)))
+			{
+				return 1;
+			}
+			p += n;
+		}
+		int32_t ddist  = unzigzag(head >> 2);
+		int32_t damp   = unzigzag(zz_amp);
+		int32_t ddtick = unzigzag(zz_tick);
+		if(!d->valid)
+		{
+			skip_cnt++;  // 没有基准，等待该雷达的下一个完整样本
+			continue;
+		}
+		d->dist    = (uint16_t)(d->dist + ddist);
+		d->amp     = (uint16_t)(d->amp + damp);
+		d->dtick   = d->dtick + (uint32_t)ddtick;
+		d->tick_ms = d->tick_ms + d->dtick;
+		put_sample(addr, d);
+	}
+	return (p == end) ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+	static uint8_t buf[4096];
+	FILE   *fp = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+	size_t len = 0, pos = 0, n;
+
+	if(NULL == fp)
+	{
+		fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	while((n = fread(buf + len, 1, sizeof(buf) - len, fp)) > 0 || (pos < len))
+	{
+		len += n;
+		while(pos < len)
+		{
+			if(MINIP_STREAM_HEAD != buf[pos])
+			{
+				pos++;
+				continue;
+			}
+			if(pos + 3 > len)
+			{
+				break;
+			}
+			uint8_t flen = buf[pos + 1];
+			uint8_t id   = buf[pos + 2];
+			if(((MINIP_STREAM_ID_SAMPLE != id) && (MINIP_STREAM_ID_DELTA != id)) || (flen < MINIP_STREAM_HEADER_LEN + 1))
+			{
+				pos++;  // 文本回复中的'Z'等
+				continue;
+			}
+			if(pos + flen > len)
+			{
+				break;
+			}
+
+			uint8_t sum = 0;
+			for(uint8_t k = 0; k < flen - 1; k++)
+			{
+				sum += buf[pos + k];
+			}
+			uint16_t seq = (uint16_t)get_le(&buf[pos + 3], 2);
+			if(sum == buf[pos + flen - 1])
+			{
+				seq_check(seq, buf[pos + 5]);
+			}
+			if((sum != buf[pos + flen - 1]) || decode_payload(id, &buf[pos + 3], &buf[pos + flen - 1]))
+			{
+				// 丢失的样本之后差分无法还原，所有雷达等待下一个完整样本
+				bad_cnt++;
+				memset(dev, 0, sizeof(dev));
+				pos++;
+				continue;
+			}
+			for(uint8_t k = 0; k < row_num; k++)
+			{
+				printf("%u,0x%02x,%u,%u,%u\n", seq, row[k].addr, row[k].dist, row[k].amp, row[k].tick_ms);
+			}
+			sample_cnt += row_num;
+			frame_cnt++;
+			pos += flen;
+		}
+
+		if((0 == n) && (pos < len))
+		{
+			break;  // 文件结束，剩余的是不完整的帧
+		}
+		memmove(buf, buf + pos, len - pos);
+		len -= pos;
+		pos = 0;
+	}
+
+	fprintf(stderr, "frames=%u samples=%u bad_frames=%u seq_gaps=%u skipped=%u\n", frame_cnt, sample_cnt, bad_cnt, gap_cnt, skip_cnt);
+	if(fp != stdin)
+	{
+		fclose(fp);
+	}
+	return 0;
+}
@@ -0,0 +1,13 @@
+#!/bin/sh
+# 检查PC端解码工具：解码stream_capture.bin并与stream_expected.csv比较，数据由gen_stream_capture.c生成，
+# 其中有夹杂的文本、整周期丢失的帧、周期中间丢失的帧和出错的字节。
+# 使用：sh check_stream_decode.sh，CC指定编译器，默认为cc
+set -e
+cd "$(dirname "$0")"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+${CC:-cc} -std=c99 -I../../User -o "$tmp/minip_stream_decode" ../minip_stream_decode.c
+"$tmp/minip_stream_decode" stream_capture.bin > "$tmp/out.csv"
+diff -u stream_expected.csv "$tmp/out.csv"
+echo "stream decode check passed"
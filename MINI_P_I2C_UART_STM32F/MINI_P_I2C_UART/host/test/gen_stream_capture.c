@@ -0,0 +1,165 @@
+/**
+  ******************************************************************************
+  * @文件    gen_stream_capture.c
+  * @描述    生成解码工具的检查数据：用固件的User/tfminip_stream.c打包30台雷达的差分压缩样本，串口数据中
+  *          夹杂文本回复和没有样本的周期，并在传输中丢掉两帧(其中一帧为周期中间的帧)、改错一个字节。
+  *          stream_capture.bin为串口收到的数据，stream_expected.csv为应解码出的样本：
+  *          丢失或出错的帧之后，差分样本在该雷达的下一个完整样本之后才恢复，其余样本与发送的数值相同。
+  *
+  * 编译：gcc -std=c99 -I../../User -o gen_stream_capture gen_stream_capture.c ../../User/tfminip_stream.c
+  * 使用：在本目录运行gen_stream_capture，覆盖stream_capture.bin和stream_expected.csv
+  ******************************************************************************
+  */
+#include <stdio.h>
+#include <string.h>
+#include "tfminip_stream.h"
+
+#define SENSOR_NUM      (30)    // 关键帧需要两帧，超出MINIP_STREAM_MAX_DEV的雷达总以完整样本发送
+#define CYCLE_NUM       (150)
+#define KEY_INTERVAL    (20)
+
+/**
+  * @描述   已打包、还未发送的样本
+  */
+typedef struct
+{
+	uint8_t  addr;
+	uint8_t  raw;       // 以完整样本发送
+	uint16_t dist;
+	uint16_t amp;
+	uint32_t tick_ms;
+}GenRowStruct;
+
+static FILE *cap, *csv;
+static GenRowStruct row[MINIP_STREAM_FRAME_MAX / 2];
+static uint8_t  row_num;
+static uint8_t  valid[128];     // 接收端有该雷达的基准
+static uint8_t  lost_single, lost_part, corrupted;
+static uint32_t seed = 1;
+
+static uint32_t gen_rand(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+/**
+  * @描述   发送函数，按接收端的解码规则把帧中的样本写入stream_expected.csv
+  * @参数   buf：整帧数据
+  * @参数   len：帧长
+  * @返回值 len，丢失的帧在发送端看来也已发送
+  */
+static uint16_t gen_write(const uint8_t *buf, uint16_t len)
+{
+	static uint8_t frame[MINIP_STREAM_FRAME_MAX];
+	uint16_t seq  = (uint16_t)(buf[3] | (buf[4] << 8));
+	uint8_t  last = buf[5] & MINIP_STREAM_LAST_FLAG;
+	uint8_t  num  = buf[6];
+	uint8_t  bad  = 0;
+
+	memcpy(frame, buf, len);
+	if(!lost_single && (seq >= 35) && (MINIP_STREAM_LAST_FLAG == buf[5]))
+	{
+		lost_single = bad = 1;          // 只有一帧的周期整帧丢失
+	}
+	else if(!lost_part && (seq >= 60) && !last)
+	{
+		lost_part = bad = 1;            // 关键帧周期的第一帧丢失，同一周期的第二帧收到
+	}
+	else if(!corrupted && (seq >= 100))
+	{
+		corrupted = bad = 1;
+		frame[10] ^= 0x04;              // 一个字节出错，校验和不符
+		fwrite(frame, 1, len, cap);
+	}
+	else
+	{
+		fwrite(frame, 1, len, cap);
+	}
+
+	if(bad)
+	{
+		memset(valid, 0, sizeof(valid));
+	}
+	for(uint8_t k = 0; k < num; k++)
+	{
+		GenRowStruct *r = &row[k];
+
+		if(r->raw)
+		{
+			valid[r->addr] = !bad;
+		}
+		if(!bad && valid[r->addr])
+		{
+			fprintf(csv, "%u,0x%02x,%u,%u,%u\n", seq, r->addr, r->dist, r->amp, r->tick_ms);
+		}
+	}
+	memmove(row, &row[num], (row_num - num) * sizeof(GenRowStruct));
+	row_num -= num;
+	return len;
+}
+
+int main(void)
+{
+	static MinipStreamStruct stream;
+	uint16_t dist[SENSOR_NUM], amp[SENSOR_NUM];
+	uint32_t tick[SENSOR_NUM];
+
+	cap = fopen("stream_capture.bin", "wb");
+	csv = fopen("stream_expected.csv", "w");
+	if((NULL == cap) || (NULL == csv))
+	{
+		fprintf(stderr, "cannot create output files\n");
+		return 1;
+	}
+
+	MinipStreamInit(&stream, gen_write);
+	MinipStreamDeltaInit(&stream, 1, KEY_INTERVAL);
+	for(uint8_t i = 0; i < SENSOR_NUM; i++)
+	{
+		dist[i] = 300 + i * 10;
+		amp[i]  = 1000 + i;
+		tick[i] = i * 3;
+	}
+
+	for(uint16_t c = 0; c < CYCLE_NUM; c++)
+	{
+		if(7 == c % 25)
+		{
+			fputs("baud 921600 actual=923076 Z err=1600ppm\r\n", cap);
+		}
+		MinipStreamBegin(&stream);
+		for(uint8_t i = 0; (i < SENSOR_NUM) && (0 != c % 17); i++)
+		{
+			MinipDataStruct data;
+			uint8_t start = stream.len;
+
+			dist[i] += (uint16_t)(gen_rand() % 5) - 2;
+			if(0 == i % 4)
+			{
+				amp[i] += (uint16_t)(gen_rand() % 3) - 1;
+			}
+			tick[i] += 10 + ((0 == gen_rand() % 20) ? 1 : 0);
+			data.dist    = dist[i];
+			data.amp     = amp[i];
+			data.tick_ms = tick[i];
+			MinipStreamAdd(&stream, 0x10 + i, &data);
+
+			if(1 == stream.num)
+			{
+				start = MINIP_STREAM_HEADER_LEN;    // 加入时先发送了放不下的上一帧
+			}
+			row[row_num].addr    = 0x10 + i;
+			row[row_num].raw     = (stream.buf[start] & MINIP_STREAM_RAW_FLAG) ? 1 : 0;
+			row[row_num].dist    = data.dist;
+			row[row_num].amp     = data.amp;
+			row[row_num].tick_ms = data.tick_ms;
+			row_num++;
+		}
+		MinipStreamEnd(&stream);
+	}
+
+	fclose(cap);
+	fclose(csv);
+	return (lost_single && lost_part && corrupted) ? 0 : 1;
+}